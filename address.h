@@ -0,0 +1,463 @@
+// Путь от приватного ключа до адреса: генерация ключа, публичный ключ,
+// Keccak-256, вывод адреса и ключа в hex и пакетный инкрементальный обход k, k+1, k+2, ...
+// Общий код для генератора, сервера задач и бенчмарков (CryptoSpiderBench).
+
+#ifndef ADDRESS_H
+#define ADDRESS_H
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstddef>
+
+#include "bytes.h"
+#include "keccak.h"
+#include "secp256k1.h"
+#include "gtable.h"
+#include "csprng.h"
+#include "mask.h"
+#include "profile.h"
+
+// 20 байт адреса (последние 20 байт Keccak-256 от публичного ключа)
+using AddressBytes = std::array<uint8_t, 20>;
+
+// Быстрая генерация случайного приватного ключа в [1, n-1] из буферизованного
+// CSPRNG потока (см. csprng.h): без системных вызовов на каждый ключ
+inline void generatePrivateKeyFast(std::vector<uint8_t>& privateKey, SecureRandom& rng) {
+    rng.nextPrivateKey(privateKey.data());
+}
+
+// Получение публичного ключа через собственную арифметику secp256k1
+// и таблицу кратных G (см. gtable.h). Формат: 0x04 + X + Y (65 байт), пустой вектор для нулевого ключа
+inline std::vector<uint8_t> getPublicKeyFast(const std::vector<uint8_t>& privateKey) {
+    secp256k1::Scalar k = secp256k1::Scalar::fromBytes(privateKey.data());
+    if (k.isZero()) {
+        return {};
+    }
+
+    secp256k1::AffinePoint point = secp256k1::toAffine(secp256k1::multiplyGeneratorFixed(k));
+    std::vector<uint8_t> publicKey(65);
+    publicKey[0] = 0x04;
+    point.serialize(publicKey.data() + 1);
+    return publicKey;
+}
+
+// Быстрое вычисление адреса без создания строки и без выделения памяти
+// Публичный ключ - только X и Y (64 байта, без префикса 0x04)
+inline AddressBytes getAddressBytes(std::span<const uint8_t, 64> publicKey) {
+    AddressBytes addressBytes;
+    Keccak::keccak256Address(publicKey, addressBytes);
+    return addressBytes;
+}
+
+// Публичный ключ в формате 0x04 + X + Y (65 байт)
+inline AddressBytes getAddressBytes(const std::vector<uint8_t>& publicKey) {
+    return getAddressBytes(std::span<const uint8_t, 64>(publicKey.data() + 1, 64));
+}
+
+// Адрес контракта, созданного CREATE с адреса sender при данном nonce:
+// keccak256(rlp([sender, nonce]))[12:]. RLP собирается побайтово, а хеш - общий
+// Keccak-256: независимая проверка пакетного Keccak::contractAddressBatch
+inline AddressBytes contractAddress(const AddressBytes& sender, uint64_t nonce) {
+    std::vector<uint8_t> rlp = {0, 0x94};
+    rlp.insert(rlp.end(), sender.begin(), sender.end());
+    if (nonce == 0) {
+        rlp.push_back(0x80);
+    } else if (nonce < 0x80) {
+        rlp.push_back(static_cast<uint8_t>(nonce));
+    } else {
+        std::vector<uint8_t> bytes;
+        for (uint64_t value = nonce; value != 0; value >>= 8) {
+            bytes.insert(bytes.begin(), static_cast<uint8_t>(value));
+        }
+        rlp.push_back(static_cast<uint8_t>(0x80 + bytes.size()));
+        rlp.insert(rlp.end(), bytes.begin(), bytes.end());
+    }
+    rlp[0] = static_cast<uint8_t>(0xc0 + rlp.size() - 1);
+    uint8_t hash[32];
+    Keccak::keccak256(rlp.data(), rlp.size(), hash);
+    AddressBytes address;
+    std::copy(hash + 12, hash + 32, address.begin());
+    return address;
+}
+
+// Конвертация байтов адреса в hex строку (без checksum, нижний регистр)
+inline std::string addressBytesToHex(const AddressBytes& addressBytes) {
+    std::stringstream ss;
+    ss << "0x";
+    for (uint8_t byte : addressBytes) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+    }
+    return ss.str();
+}
+
+// Получение адреса с checksum для проверки маски (EIP-55)
+inline std::string getAddressWithChecksum(const AddressBytes& addressBytes) {
+    // EIP-55: хешируем адрес как строку в нижнем регистре (без 0x)
+    std::string addressLower;
+    for (uint8_t byte : addressBytes) {
+        addressLower += hexChars[(byte >> 4) & 0x0F];
+        addressLower += hexChars[byte & 0x0F];
+    }
+    
+    // Вычисляем Keccak-256 хеш строки адреса
+    uint8_t hash[32];
+    eip55Hash(addressBytes.data(), hash);
+    
+    // Создаем адрес с checksum
+    // Для каждого символа адреса берем соответствующий nibble из хеша
+    // Если nibble >= 8, символ должен быть заглавным
+    std::string result = "0x";
+    for (size_t i = 0; i < addressLower.length(); i++) {
+        char c = addressLower[i];
+        
+        // Получаем соответствующий nibble из хеша
+        size_t hashByteIndex = i / 2;
+        bool isHighNibble = (i % 2 == 0);
+        uint8_t hashNibble = isHighNibble ? 
+            ((hash[hashByteIndex] >> 4) & 0x0F) : 
+            (hash[hashByteIndex] & 0x0F);
+        
+        // Применяем checksum (EIP-55): если nibble хеша >= 8, символ должен быть заглавным
+        if (hashNibble >= 8 && c >= 'a' && c <= 'f') {
+            c = c - 'a' + 'A';
+        }
+        
+        result += c;
+    }
+    
+    return result;
+}
+
+// Конвертация приватного ключа в hex строку (всегда полный формат)
+inline std::string privateKeyToHex(const std::vector<uint8_t>& privateKey) {
+    std::stringstream ss;
+    ss << "0x";
+    ss << std::hex << std::setfill('0');
+    for (uint8_t byte : privateKey) {
+        ss << std::setw(2) << static_cast<int>(byte);
+    }
+    return ss.str();
+}
+
+// Байты из hex (с 0x, 0X или без), ровно size байт
+inline bool parseHexBytes(const std::string& text, uint8_t* out, size_t size) {
+    std::string hex = text.rfind("0x", 0) == 0 || text.rfind("0X", 0) == 0 ? text.substr(2) : text;
+    if (hex.size() != size * 2 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+        out[i] = static_cast<uint8_t>(hexNibble(hex[i * 2]) << 4 | hexNibble(hex[i * 2 + 1]));
+    }
+    return true;
+}
+
+// Разбор публичного ключа в hex (с 0x или без): сжатый 33 байта или несжатый 65 байт
+inline bool parsePublicKeyHex(const std::string& text, secp256k1::AffinePoint& point, std::string& error) {
+    uint8_t bytes[65];
+    size_t size = parseHexBytes(text, bytes, 33) ? 33 : parseHexBytes(text, bytes, 65) ? 65 : 0;
+    if (size == 0) {
+        error = "публичный ключ должен быть 33 (сжатый) или 65 байт в hex";
+        return false;
+    }
+    if (!secp256k1::parsePublicKey(bytes, size, point)) {
+        error = "публичный ключ не является точкой кривой secp256k1";
+        return false;
+    }
+    return true;
+}
+
+// Сжатый публичный ключ в hex (0x02/0x03 + X), каноническая форма для вывода
+inline std::string publicKeyToHex(const secp256k1::AffinePoint& point) {
+    uint8_t bytes[33];
+    bytes[0] = static_cast<uint8_t>(0x02 | (point.y.n[0] & 1));
+    point.x.toBytes(bytes + 1);
+    std::string out = "0x";
+    for (uint8_t byte : bytes) {
+        out += hexChars[byte >> 4];
+        out += hexChars[byte & 0x0F];
+    }
+    return out;
+}
+
+// Количество точек в одном пакете инкрементального обхода по умолчанию.
+// Все точки пакета переводятся в аффинные координаты одной общей инверсией
+const size_t WALK_BATCH_SIZE = 2048;
+
+// Допустимые размеры пакета: степени двойки (пакеты должны делить блок разбиения
+// ключей, см. partition.h, а битовая карта совпадений - состоять из целых слов)
+const size_t MIN_WALK_BATCH_SIZE = 256;
+const size_t MAX_WALK_BATCH_SIZE = 16384;
+
+inline bool validWalkBatchSize(size_t size) {
+    return size >= MIN_WALK_BATCH_SIZE && size <= MAX_WALK_BATCH_SIZE && (size & (size - 1)) == 0;
+}
+
+// Наибольшее число nonce в режиме адресов контрактов (см. KeyWalker::setContractNonces):
+// буфер адресов пакета растет пропорционально
+const size_t MAX_CONTRACT_NONCES = 16;
+
+// Адресов на одну вычисленную точку P = k*G при использовании симметрий кривой:
+// P, -P, lambda*P, -lambda*P, lambda^2*P, -lambda^2*P (см. KeyWalker)
+const size_t SYMMETRY_VARIANTS = 6;
+
+// Инкрементальный обход k, k+1, k+2, ...
+// Вместо умножения на скаляр для каждого ключа прибавляем G к предыдущей точке
+// (смешанное сложение в якобиевых координатах без инверсии), а пакет из
+// batchSize точек переводим в аффинные координаты одной общей инверсией
+// (трюк Монтгомери) и хешируем пакетным Keccak.
+// Данные пакета лежат массивами по стадиям (структура массивов), каждая стадия -
+// плотный цикл по всему пакету: точки -> 64-байтные публичные ключи -> 20-байтные
+// адреса -> битовая карта совпадений (заполняет SearchJob::scanBatch или, с фильтром
+// маски, сам Keccak - см. setAddressFilter). Ключи восстанавливаются только для
+// адресов, прошедших проверку. Буферы выделяются
+// один раз на весь обход, размер пакета подбирается под кэш (см. chooseWalkBatchSize).
+// Симметрии кривой дают из каждой точки (x, y) еще пять публичных ключей почти даром:
+// (x, -y) - ключ n - k, (beta*x, y) - ключ lambda*k, (beta^2*x, y) - lambda^2*k и их
+// отрицания. Это одно умножение или вычитание в поле на ключ вместо сложения точек
+// и доли инверсии, поэтому пакет дает SYMMETRY_VARIANTS * batchSize адресов.
+// Адрес i относится к варианту i / batchSize точки i % batchSize.
+// С базовой точкой Q (режим разделенного ключа) обходятся точки Q + k*G, Q + (k+1)*G, ...:
+// адрес ищется для суммы, а результатом остается только смещение k. Симметрии
+// в этом режиме отключены: -(Q + k*G) и lambda*(Q + k*G) не выражаются через смещение.
+// Если же скаляр Q известен тому, кто получает результат (рабочий кластера, см. cluster.h),
+// симметрии остаются: результат - смещение и номер симметрии (offsetAt, symmetryAt).
+// В режиме адресов контрактов (setContractNonces) адреса ключей - только промежуточный
+// буфер, а проверяются адреса контрактов CREATE с них при nonce 0..N-1: блок nonce n
+// занимает адреса n * M .. (n + 1) * M - 1, где M - адресов ключей в пакете
+class KeyWalker {
+public:
+    explicit KeyWalker(size_t batchSize = WALK_BATCH_SIZE)
+        : size(batchSize), points(batchSize), affinePoints(batchSize),
+          publicKeys(batchSize * 64), addresses(SYMMETRY_VARIANTS * batchSize * 20),
+          matches(SYMMETRY_VARIANTS * batchSize / 64) {}
+
+    // Базовая точка Q для последующих start; бесконечно удаленная точка - обычный режим.
+    // keepSymmetries - симметрии и с базовой точкой (ключ восстанавливается по
+    // смещению и номеру симметрии, см. applySymmetry)
+    void setBasePoint(const secp256k1::AffinePoint& point, bool keepSymmetries = false) {
+        basePoint = point;
+        baseSymmetries = keepSymmetries;
+        variants = (point.infinity || keepSymmetries) && symmetries ? SYMMETRY_VARIANTS : 1;
+    }
+
+    // Включение симметрий кривой (по умолчанию включены, кроме режима разделенного ключа)
+    void setSymmetries(bool enabled) {
+        symmetries = enabled;
+        setBasePoint(basePoint, baseSymmetries);
+    }
+
+    // Отметки стадий пакета для профилирования (см. profile.h); nullptr - без отметок
+    void setStageTimer(StageTimer* stageTimer) {
+        timer = stageTimer;
+    }
+
+    StageTimer* stageTimer() const {
+        return timer;
+    }
+
+    // Фильтр маски в последнем раунде Keccak (см. Keccak::AddressFilter): адрес пишется
+    // только для прошедших его кандидатов, их биты - сразу в matchBitmap(), остальные
+    // адреса пакета не определены. nullptr - все адреса, карту заполняет проверка.
+    // В режиме адресов контрактов фильтруются адреса контрактов
+    void setAddressFilter(const Keccak::AddressFilter* addressFilter) {
+        filter = addressFilter;
+    }
+
+    bool filtered() const {
+        return filter != nullptr;
+    }
+
+    // Количество точек в пакете
+    size_t batchSize() const {
+        return size;
+    }
+
+    // Адреса контрактов CREATE ключей с nonce 0..count-1 вместо адресов ключей; 0 - выключено
+    void setContractNonces(size_t count) {
+        if (count == nonces) {
+            return;
+        }
+        nonces = count;
+        size_t blocks = std::max<size_t>(1, count);
+        addresses.resize(SYMMETRY_VARIANTS * size * blocks * 20);
+        matches.resize(SYMMETRY_VARIANTS * size * blocks / 64);
+        senders.resize(count > 0 ? SYMMETRY_VARIANTS * size * 20 : 0);
+    }
+
+    // Количество адресов в пакете
+    size_t addressCount() const {
+        return variants * size * std::max<size_t>(1, nonces);
+    }
+
+    // Вычислений Keccak-256 на пакет: адреса ключей и, в режиме адресов контрактов,
+    // еще по одному на каждый nonce
+    size_t hashCount() const {
+        return variants * size * (1 + nonces);
+    }
+
+    // Начало обхода с ключа k: точка k*G (k != 0) или Q + k*G
+    void start(const secp256k1::Scalar& k) {
+        baseKey = k;
+        current = secp256k1::addMixed(secp256k1::multiplyGeneratorFixed(k), basePoint);
+    }
+
+    // Вычисляет адреса ключей baseKey .. baseKey + batchSize - 1.
+    // false, если обход прошел через бесконечно удаленную точку (k+i == n):
+    // пакет непригоден, нужно начать с новой точки
+    bool computeBatch() {
+        // Заполняем пакет: points[i] = P + i*G
+        stage(ProfileStage::Points);
+        points[0] = current;
+        current = secp256k1::walkGenerator(points.data(), size);
+
+        if (current.infinity || points[size - 1].infinity) {
+            return false;
+        }
+
+        stage(ProfileStage::Inverse);
+        secp256k1::walkToAffine(points.data(), affinePoints.data(), size);
+
+        // Варианты по два: (x, y) и (x, -y), затем x умножается на beta.
+        // Публичные ключи варианта хешируются одним вызовом (SIMD по 4 или 8 ключей)
+        // сразу в массив адресов
+        using F = secp256k1::FieldElement;
+        const F& beta = secp256k1::endomorphismBeta();
+        uint8_t* keyAddresses = nonces > 0 ? senders.data() : addresses.data();
+        for (size_t variant = 0; variant < variants; variant++) {
+            bool negate = variant % 2 == 1;
+            stage(ProfileStage::Serialize);
+            if (variant > 0 && !negate) {
+                for (size_t i = 0; i < size; i++) {
+                    affinePoints[i].x = F::mul(affinePoints[i].x, beta);
+                }
+            }
+            for (size_t i = 0; i < size; i++) {
+                uint8_t* out = publicKeys.data() + i * 64;
+                affinePoints[i].x.toBytes(out);
+                (negate ? F::neg(affinePoints[i].y) : affinePoints[i].y).toBytes(out + 32);
+            }
+            stage(ProfileStage::Keccak);
+            Keccak::keccak256AddressBatch64(publicKeys.data(), keyAddresses + variant * size * 20, size,
+                                            nonces > 0 ? nullptr : filter, matches.data() + variant * size / 64);
+        }
+        for (size_t nonce = 0; nonce < nonces; nonce++) {
+            Keccak::contractAddressBatch(senders.data(), nonce, addresses.data() + nonce * variants * size * 20,
+                                         variants * size, filter, matches.data() + nonce * variants * size / 64);
+        }
+        return true;
+    }
+
+    // Переход к следующему пакету: k + batchSize
+    void advance() {
+        baseKey = secp256k1::Scalar::add(baseKey, secp256k1::Scalar::fromUint64(size));
+    }
+
+    // Адрес i-го ключа пакета (20 байт)
+    const uint8_t* address(size_t i) const {
+        return addresses.data() + i * 20;
+    }
+
+    // Битовая карта совпадений пакета: addressCount() / 64 слов, бит i - адрес i
+    uint64_t* matchBitmap() {
+        return matches.data();
+    }
+
+    // Приватный ключ (с базовой точкой - смещение) i-го адреса пакета.
+    // С базовой точкой и симметриями - только offsetAt и symmetryAt
+    secp256k1::Scalar keyAt(size_t i) const {
+        return applySymmetry(offsetAt(i), symmetryAt(i));
+    }
+
+    // k + i (mod n) для точки i-го адреса пакета
+    secp256k1::Scalar offsetAt(size_t i) const {
+        return secp256k1::Scalar::add(baseKey, secp256k1::Scalar::fromUint64(i % size));
+    }
+
+    // Номер симметрии i-го адреса пакета (0 - сама точка)
+    size_t symmetryAt(size_t i) const {
+        return i % (variants * size) / size;
+    }
+
+    // Ключ симметрии variant точки с ключом key: key, умноженный на lambda^(variant / 2)
+    // и взятый с обратным знаком для нечетных вариантов
+    static secp256k1::Scalar applySymmetry(secp256k1::Scalar key, size_t variant) {
+        using secp256k1::Scalar;
+        for (size_t power = 0; power < variant / 2; power++) {
+            key = Scalar::mul(key, secp256k1::endomorphismLambda());
+        }
+        return variant % 2 == 1 ? Scalar::neg(key) : key;
+    }
+
+    // Та же симметрия точки: x * beta^(variant / 2), y с обратным знаком для нечетных
+    static secp256k1::AffinePoint applySymmetry(secp256k1::AffinePoint point, size_t variant) {
+        using F = secp256k1::FieldElement;
+        for (size_t power = 0; power < variant / 2; power++) {
+            point.x = F::mul(point.x, secp256k1::endomorphismBeta());
+        }
+        if (variant % 2 == 1) {
+            point.y = F::neg(point.y);
+        }
+        return point;
+    }
+
+    // nonce контракта i-го адреса пакета (0, если режим адресов контрактов выключен)
+    size_t nonceAt(size_t i) const {
+        return i / (variants * size);
+    }
+
+    // Память пакета на одну точку: якобиева и аффинная точки, публичный ключ
+    // одного варианта, адреса и биты всех вариантов
+    static constexpr size_t bytesPerPoint() {
+        return sizeof(secp256k1::JacobianPoint) + sizeof(secp256k1::AffinePoint) + 64 +
+               SYMMETRY_VARIANTS * 20 + SYMMETRY_VARIANTS / 8 + 1;
+    }
+
+private:
+    size_t size;
+    std::vector<secp256k1::JacobianPoint> points;
+    std::vector<secp256k1::AffinePoint> affinePoints;
+    secp256k1::JacobianPoint current;
+    secp256k1::Scalar baseKey;
+    secp256k1::AffinePoint basePoint{{}, {}, true};
+    bool symmetries = true;
+    bool baseSymmetries = false;
+    size_t variants = SYMMETRY_VARIANTS;
+    size_t nonces = 0;
+
+    // Публичные ключи (X || Y) одного варианта для пакетного Keccak и адреса всех вариантов
+    std::vector<uint8_t> publicKeys;
+    std::vector<uint8_t> addresses;
+    std::vector<uint64_t> matches;
+    std::vector<uint8_t> senders;  // Адреса ключей в режиме адресов контрактов
+    StageTimer* timer = nullptr;
+    const Keccak::AddressFilter* filter = nullptr;
+
+    void stage(ProfileStage next) {
+        if (timer) {
+            timer->begin(next);
+        }
+    }
+};
+
+// Размер пакета под кэш: наибольшая степень двойки, при которой данные пакета
+// занимают не больше половины L2 (вторая половина - таблица G, маски и стек).
+// Меньшие пакеты чаще платят за инверсию (~270 умножений на пакет), поэтому
+// снизу размер ограничен MIN_WALK_BATCH_SIZE. l2Bytes = 0 - размер кэша неизвестен
+inline size_t chooseWalkBatchSize(size_t l2Bytes) {
+    if (l2Bytes == 0) {
+        return WALK_BATCH_SIZE;
+    }
+    size_t size = MIN_WALK_BATCH_SIZE;
+    while (size * 2 <= MAX_WALK_BATCH_SIZE && size * 2 * KeyWalker::bytesPerPoint() <= l2Bytes / 2) {
+        size *= 2;
+    }
+    return size;
+}
+
+#endif // ADDRESS_H
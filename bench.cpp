@@ -0,0 +1,444 @@
+// CryptoSpiderBench - микробенчмарки отдельных этапов генератора
+// и сквозного рабочего цикла на 1..N потоках.
+// Объем работы и все входные данные фиксированы и выводятся из --seed,
+// поэтому запуски разных сборок сравнимы между собой.
+//
+// Использование:
+//   CryptoSpiderBench [--seed N] [--threads N] [--scale X] [--batch-size N] [--gtable FILE]
+//                     [--json FILE] [--csv FILE]
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <random>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "keccak.h"
+#include "secp256k1.h"
+#include "mask.h"
+#include "address.h"
+#include "create2.h"
+#include "selfcheck.h"
+
+// Счетчик тактов: TSC на x86 (опорная частота, не зависит от турбо-режима),
+// на остальных платформах такты не измеряются
+inline uint64_t readCycles() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Результат одного бенчмарка
+struct BenchResult {
+    std::string name;
+    unsigned int threads;
+    uint64_t keys;
+    double seconds;
+    uint64_t cycles;  // Такты на всех потоках (0 - не измерялись)
+
+    double keysPerSecond() const { return keys / seconds; }
+    double nsPerKey() const { return seconds * 1e9 / keys; }
+    double cyclesPerKey() const { return static_cast<double>(cycles) / keys; }
+};
+
+// Результат вычислений копится здесь, чтобы компилятор не выбросил измеряемый код
+volatile uint64_t benchSink = 0;
+
+// Запуск тела бенчмарка и замер времени и тактов
+BenchResult measure(const std::string& name, unsigned int threads, uint64_t keys,
+                    const std::function<void()>& body) {
+    auto startTime = std::chrono::steady_clock::now();
+    uint64_t startCycles = readCycles();
+    body();
+    uint64_t cycles = readCycles() - startCycles;
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+
+    BenchResult result;
+    result.name = name;
+    result.threads = threads;
+    result.keys = keys;
+    result.seconds = std::chrono::duration<double>(elapsed).count();
+    result.cycles = cycles * threads;
+    return result;
+}
+
+// Случайные 64-байтные публичные ключи (X || Y) - вход для Keccak
+std::vector<uint8_t> randomPublicKeys(std::mt19937& gen, size_t count) {
+    std::vector<uint8_t> publicKeys(count * 64);
+    for (auto& byte : publicKeys) {
+        byte = static_cast<uint8_t>(gen());
+    }
+    return publicKeys;
+}
+
+// Стартовый ключ потока сквозного бенчмарка
+secp256k1::Scalar startKeyFor(uint64_t seed, unsigned int threadId) {
+    SecureRandom rng(seed * 1000003 + threadId);
+    return rng.nextScalar();
+}
+
+std::vector<BenchResult> runBenchmarks(uint64_t seed, unsigned int maxThreads, double scale, size_t batchSize) {
+    auto count = [scale](uint64_t base) {
+        return std::max<uint64_t>(1, static_cast<uint64_t>(base * scale));
+    };
+    std::vector<BenchResult> results;
+    std::mt19937 gen(static_cast<uint32_t>(seed));
+
+    // Генерация приватного ключа
+    {
+        uint64_t keys = count(4000000);
+        std::vector<uint8_t> privateKey(32);
+        SecureRandom keyGen(seed);
+        results.push_back(measure("generatePrivateKeyFast", 1, keys, [&] {
+            for (uint64_t i = 0; i < keys; i++) {
+                generatePrivateKeyFast(privateKey, keyGen);
+                benchSink = benchSink + privateKey[i & 31];
+            }
+        }));
+    }
+
+    // Умножение k*G (полное, без инкрементального обхода): общий алгоритм
+    // с окном 4 бита и таблица кратных G (встроенная или --gtable)
+    {
+        uint64_t keys = count(4000);
+        SecureRandom keyGen(seed);
+        std::vector<std::vector<uint8_t>> privateKeys(keys, std::vector<uint8_t>(32));
+        for (auto& privateKey : privateKeys) {
+            generatePrivateKeyFast(privateKey, keyGen);
+        }
+        std::vector<secp256k1::Scalar> scalars;
+        for (const auto& privateKey : privateKeys) {
+            scalars.push_back(secp256k1::Scalar::fromBytes(privateKey.data()));
+        }
+        results.push_back(measure("multiplyGenerator (window 4)", 1, keys, [&] {
+            for (const auto& k : scalars) {
+                benchSink = benchSink + secp256k1::multiplyGenerator(k).x.n[0];
+            }
+        }));
+        secp256k1::generatorTable();
+        results.push_back(measure("multiplyGeneratorFixed", 1, keys, [&] {
+            for (const auto& k : scalars) {
+                benchSink = benchSink + secp256k1::multiplyGeneratorFixed(k).x.n[0];
+            }
+        }));
+        results.push_back(measure("getPublicKeyFast", 1, keys, [&] {
+            for (const auto& privateKey : privateKeys) {
+                std::vector<uint8_t> publicKey = getPublicKeyFast(privateKey);
+                benchSink = benchSink + (publicKey.empty() ? 0 : publicKey[64]);
+            }
+        }));
+    }
+
+    const size_t inputCount = 4096;
+    std::vector<uint8_t> publicKeys = randomPublicKeys(gen, inputCount);
+
+    // Keccak-256 одного 64-байтного ключа
+    {
+        uint64_t keys = count(400000);
+        uint8_t digest[32];
+        results.push_back(measure("Keccak::keccak256", 1, keys, [&] {
+            for (uint64_t i = 0; i < keys; i++) {
+                Keccak::keccak256(publicKeys.data() + (i % inputCount) * 64, 64, digest);
+                benchSink = benchSink + digest[31];
+            }
+        }));
+    }
+
+    // Пакетный Keccak-256 (SIMD, если поддерживается процессором)
+    {
+        uint64_t rounds = count(100);
+        std::vector<uint8_t> digests(inputCount * 32);
+        results.push_back(measure("Keccak::keccak256Batch64", 1, rounds * inputCount, [&] {
+            for (uint64_t r = 0; r < rounds; r++) {
+                Keccak::keccak256Batch64(publicKeys.data(), digests.data(), inputCount);
+                benchSink = benchSink + digests[r % digests.size()];
+            }
+        }));
+    }
+
+    // Пакет адресов CREATE2: постоянная часть входа поглощена, меняется счетчик соли
+    {
+        uint64_t rounds = count(100);
+        uint8_t input[Keccak::CREATE2_INPUT_BYTES];
+        for (auto& byte : input) {
+            byte = static_cast<uint8_t>(gen());
+        }
+        std::vector<uint8_t> addresses(inputCount * 20);
+        results.push_back(measure("Keccak::create2AddressBatch", 1, rounds * inputCount, [&] {
+            for (uint64_t r = 0; r < rounds; r++) {
+                Keccak::create2AddressBatch(input, r * inputCount, addresses.data(), inputCount);
+                benchSink = benchSink + addresses[r % addresses.size()];
+            }
+        }));
+    }
+
+    // Адрес из публичного ключа
+    {
+        uint64_t keys = count(400000);
+        results.push_back(measure("getAddressBytes", 1, keys, [&] {
+            for (uint64_t i = 0; i < keys; i++) {
+                AddressBytes addressBytes = getAddressBytes(
+                    std::span<const uint8_t, 64>(publicKeys.data() + (i % inputCount) * 64, 64));
+                benchSink = benchSink + addressBytes[19];
+            }
+        }));
+    }
+
+    // Проверка маски: случайные адреса, почти все отсекаются сравнением слов
+    std::vector<uint8_t> addresses(inputCount * 20);
+    for (auto& byte : addresses) {
+        byte = static_cast<uint8_t>(gen());
+    }
+    auto benchMask = [&](const std::string& name, const std::string& prefix, const std::string& suffix) {
+        Mask mask;
+        std::string error;
+        parseMask(prefix, suffix, mask, error);
+        CompiledMask compiled = compileMask(mask);
+        uint64_t keys = count(mask.checkCase ? 400000 : 20000000);
+        results.push_back(measure(name, 1, keys, [&] {
+            withMaskMatcher(compiled, [&](auto&& matches) {
+                uint64_t hits = 0;
+                for (uint64_t i = 0; i < keys; i++) {
+                    hits += matches(addresses.data() + (i % inputCount) * 20);
+                }
+                benchSink = benchSink + hits;
+            });
+        }));
+    };
+    benchMask("mask lowercase", "ab", "1234");
+
+    // EIP-55: все адреса проходят проверку без учета регистра,
+    // поэтому checksum (второй Keccak) считается для каждого
+    for (size_t i = 0; i < inputCount; i++) {
+        addresses[i * 20] = 0xab;
+    }
+    benchMask("mask EIP-55", "aB", "");
+
+    // Сквозной рабочий цикл: обход, пакетный Keccak и проверка маски на 1..N потоках
+    Mask mask;
+    std::string error;
+    parseMask("ab", "1234", mask, error);
+    CompiledMask compiled = compileMask(mask);
+    uint64_t batchesPerThread = count(16);
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    auto workerLoop = [&](const std::string& name, unsigned int threads, bool symmetries, size_t contractNonces = 0) {
+        std::vector<KeyWalker> walkers;
+        for (unsigned int t = 0; t < threads; t++) {
+            walkers.emplace_back(batchSize);
+            walkers[t].setSymmetries(symmetries);
+            walkers[t].setContractNonces(contractNonces);
+            walkers[t].start(startKeyFor(seed, t));
+        }
+        uint64_t keys = threads * batchesPerThread * walkers[0].addressCount();
+        results.push_back(measure(name, threads, keys, [&] {
+            std::vector<std::thread> pool;
+            for (unsigned int t = 0; t < threads; t++) {
+                pool.emplace_back([&, t] {
+                    KeyWalker& walker = walkers[t];
+                    uint64_t hits = 0;
+                    withMaskMatcher(compiled, [&](auto&& matches) {
+                        for (uint64_t b = 0; b < batchesPerThread; b++) {
+                            walker.computeBatch();
+                            for (size_t i = 0; i < walker.addressCount(); i++) {
+                                hits += matches(walker.address(i));
+                            }
+                            walker.advance();
+                        }
+                    });
+                    benchSink = benchSink + hits;
+                });
+            }
+            for (auto& thread : pool) {
+                thread.join();
+            }
+        }));
+    };
+    // Без симметрий кривой: один адрес на точку, для сравнения
+    workerLoop("worker loop no-symmetry", 1, false);
+    // Адреса контрактов ключей (CREATE, nonce 0): второй Keccak на адрес
+    workerLoop("worker loop contract", 1, true, 1);
+    for (unsigned int threads : threadCounts) {
+        workerLoop("worker loop", threads, true);
+    }
+
+    // Перебор солей CREATE2 с той же маской: пакетный Keccak без кривой
+    Create2Params create2;
+    for (auto& byte : create2.deployer) {
+        byte = static_cast<uint8_t>(gen());
+    }
+    for (auto& byte : create2.initCodeHash) {
+        byte = static_cast<uint8_t>(gen());
+    }
+    uint64_t saltBatchesPerThread = count(256);
+    for (unsigned int threads : threadCounts) {
+        std::vector<SaltWalker> walkers;
+        for (unsigned int t = 0; t < threads; t++) {
+            walkers.emplace_back(batchSize);
+            walkers[t].setParams(create2);
+            SecureRandom rng(seed * 1000003 + t);
+            walkers[t].start(rng);
+        }
+        uint64_t keys = threads * saltBatchesPerThread * batchSize;
+        results.push_back(measure("create2 loop", threads, keys, [&] {
+            std::vector<std::thread> pool;
+            for (unsigned int t = 0; t < threads; t++) {
+                pool.emplace_back([&, t] {
+                    SaltWalker& walker = walkers[t];
+                    uint64_t hits = 0;
+                    withMaskMatcher(compiled, [&](auto&& matches) {
+                        for (uint64_t b = 0; b < saltBatchesPerThread && walker.computeBatch(); b++) {
+                            for (size_t i = 0; i < walker.addressCount(); i++) {
+                                hits += matches(walker.address(i));
+                            }
+                            walker.advance();
+                        }
+                    });
+                    benchSink = benchSink + hits;
+                });
+            }
+            for (auto& thread : pool) {
+                thread.join();
+            }
+        }));
+    }
+
+    return results;
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results, uint64_t seed) {
+    out << "{\n  \"seed\": " << seed << ",\n  \"cpu_variant\": \"" << cpuVariantName(activeCpuVariant())
+        << "\",\n  \"cycles_measured\": "
+        << (readCycles() != 0 ? "true" : "false") << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"threads\": " << r.threads
+            << ", \"keys\": " << r.keys << std::fixed << std::setprecision(6)
+            << ", \"seconds\": " << r.seconds
+            << ", \"keys_per_sec\": " << std::setprecision(1) << r.keysPerSecond()
+            << ", \"ns_per_key\": " << std::setprecision(3) << r.nsPerKey()
+            << ", \"cycles_per_key\": " << std::setprecision(1) << r.cyclesPerKey() << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "name,threads,keys,seconds,keys_per_sec,ns_per_key,cycles_per_key\n";
+    for (const BenchResult& r : results) {
+        out << r.name << "," << r.threads << "," << r.keys << std::fixed
+            << "," << std::setprecision(6) << r.seconds
+            << "," << std::setprecision(1) << r.keysPerSecond()
+            << "," << std::setprecision(3) << r.nsPerKey()
+            << "," << std::setprecision(1) << r.cyclesPerKey() << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    unsigned int maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 4;
+    double scale = 1.0;
+    size_t batchSize = WALK_BATCH_SIZE;
+    std::string jsonFile;
+    std::string csvFile;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            maxThreads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--scale" && i + 1 < argc) {
+            scale = std::stod(argv[++i]);
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            batchSize = std::stoull(argv[++i]);
+            if (!validWalkBatchSize(batchSize)) {
+                std::cerr << "Ошибка: --batch-size должен быть степенью двойки от " << MIN_WALK_BATCH_SIZE
+                          << " до " << MAX_WALK_BATCH_SIZE << std::endl;
+                return 1;
+            }
+        } else if (arg == "--gtable" && i + 1 < argc) {
+            std::string error;
+            auto table = secp256k1::GeneratorTable::load(argv[++i], error);
+            if (!table) {
+                std::cerr << "Ошибка: " << error << std::endl;
+                return 1;
+            }
+            secp256k1::installGeneratorTable(std::move(table));
+        } else if (arg == "--cpu-variant" && i + 1 < argc) {
+            CpuVariant variant;
+            std::string name = argv[++i];
+            if (!parseCpuVariant(name, variant) || !forceCpuVariant(variant)) {
+                std::cerr << "Ошибка: вариант ядер недоступен: " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csvFile = argv[++i];
+        } else {
+            std::cerr << "Ошибка: неизвестный аргумент: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    // Скорость неверного ядра ничего не значит: сначала все варианты против скалярного keccak256
+    std::string kernelError;
+    if (!checkAllKeccakKernels(kernelError)) {
+        std::cerr << "Ошибка: самопроверка ядер Keccak: " << kernelError << std::endl;
+        return 1;
+    }
+
+    std::cout << "=== CryptoSpiderBench (seed " << seed << ", до " << maxThreads << " потоков, ядра "
+              << cpuVariantName(activeCpuVariant()) << ") ===" << std::endl;
+    std::vector<BenchResult> results = runBenchmarks(seed, maxThreads, scale, batchSize);
+
+    std::cout << std::left << std::setw(28) << "stage" << std::right << std::setw(8) << "threads"
+              << std::setw(16) << "keys/sec" << std::setw(12) << "ns/key" << std::setw(14) << "cycles/key"
+              << std::endl;
+    for (const BenchResult& r : results) {
+        std::cout << std::left << std::setw(28) << r.name << std::right << std::setw(8) << r.threads
+                  << std::fixed << std::setprecision(0) << std::setw(16) << r.keysPerSecond()
+                  << std::setprecision(2) << std::setw(12) << r.nsPerKey()
+                  << std::setprecision(1) << std::setw(14) << r.cyclesPerKey() << std::endl;
+    }
+
+    if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile);
+        if (!out) {
+            std::cerr << "Ошибка: не удалось открыть файл: " << jsonFile << std::endl;
+            return 1;
+        }
+        writeJson(out, results, seed);
+    }
+    if (!csvFile.empty()) {
+        std::ofstream out(csvFile);
+        if (!out) {
+            std::cerr << "Ошибка: не удалось открыть файл: " << csvFile << std::endl;
+            return 1;
+        }
+        writeCsv(out, results);
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+// Общие примитивы для байтов: слова big-endian и hex-алфавит.
+// Используются арифметикой поля, проверкой масок, TRON и выводом адресов.
+
+#ifndef BYTES_H
+#define BYTES_H
+
+#include <cstdint>
+
+// Lookup таблица для быстрого преобразования байта в hex символ
+inline constexpr char hexChars[] = "0123456789abcdef";
+
+// 8 байт big-endian (компилятор сворачивает цикл в загрузку и bswap)
+inline uint64_t loadBE64(const uint8_t* p) {
+    uint64_t r = 0;
+    for (int i = 0; i < 8; i++) {
+        r = (r << 8) | p[i];
+    }
+    return r;
+}
+
+inline void storeBE64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = static_cast<uint8_t>(v);
+        v >>= 8;
+    }
+}
+
+#endif // BYTES_H
@@ -0,0 +1,823 @@
+// Кластер: одна задача на нескольких процессах, на одной машине или на многих.
+// Координатор держит разбиение пространства ключей (см. partition.h) и раздает рабочим
+// процессам аренды - диапазоны блоков; рабочий обходит их своим пулом потоков и
+// сообщает о завершенных арендах, проверенных адресах и совпадениях. Аренды
+// отключившегося или зависшего рабочего возвращаются в очередь и достаются другим.
+// Совпадение координатор проверяет сам (ключ -> адрес через AddressVerifier, затем
+// правила задачи) и, как только задача выполнена, рассылает отмену всем рабочим.
+// Рабочие ничего не делят между собой и получают новую аренду, закончив прежнюю,
+// поэтому скорость растет с числом узлов линейно, а медленные узлы берут меньше блоков.
+//
+// Протокол - строки JSON по TCP или Unix-сокету (разбор как у сервера задач, server.h).
+// Рабочий -> координатор:
+//   {"event": "ready", "threads": 8}
+//   {"event": "progress", "attempts": 123456}    (раз в секунду, адресов с начала задачи)
+//   {"event": "lease_done", "lease": 3}
+//   {"id": "", "event": "hit", "address": "0x...", "offset": "0x...", "symmetry": 2, "verified": true}
+//   {"event": "done", "attempts": 123456}          (задача рабочего остановилась: сама или по отмене)
+// Координатор -> рабочий:
+//   {"event": "job", "base_point": "0x02...", "prefix": "ab", "count": 1}   (поля задачи - как в server.h)
+//   {"event": "lease", "lease": 3, "first": 1024, "count": 32}    (блоки first .. first+count-1)
+//   {"event": "revoke", "lease": 3}
+//   {"event": "cancel"}
+// Секретный базовый скаляр разбиения B не покидает координатора: рабочие получают точку
+// B*G (с разделенным ключом - Q + B*G) и обходят B*G + k*G, как в режиме разделенного
+// ключа, но с симметриями кривой. Совпадение приходит смещением k и номером симметрии,
+// ключ (B + k с этой симметрией) восстанавливает и проверяет координатор. Соединение
+// не шифруется и не аутентифицируется, поэтому без явного хоста координатор слушает
+// только 127.0.0.1: подключившийся узнает задачу, но не ключи.
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "address.h"
+#include "partition.h"
+#include "search.h"
+#include "server.h"
+
+// Сокет кластера по адресу: путь Unix-сокета (содержит '/') или хост:порт,
+// просто порт - 127.0.0.1. listen - слушающий сокет, иначе подключение. -1 при ошибке
+inline int clusterSocket(const std::string& address, bool listen, std::string& error) {
+    // Запись в закрытое другой стороной соединение не должна завершать процесс
+    std::signal(SIGPIPE, SIG_IGN);
+    if (address.find('/') != std::string::npos) {
+        sockaddr_un local{};
+        local.sun_family = AF_UNIX;
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || address.size() >= sizeof(local.sun_path)) {
+            error = "не удалось открыть сокет: " + address;
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+        std::copy(address.begin(), address.end(), local.sun_path);
+        if (listen) {
+            ::unlink(address.c_str());
+        }
+        auto* target = reinterpret_cast<sockaddr*>(&local);
+        if (listen ? ::bind(fd, target, sizeof(local)) != 0 || ::listen(fd, 64) != 0
+                   : ::connect(fd, target, sizeof(local)) != 0) {
+            error = "не удалось " + std::string(listen ? "открыть" : "подключиться к") + " сокет: " + address;
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    std::string host = "127.0.0.1";
+    std::string port = address;
+    size_t colon = address.rfind(':');
+    if (colon != std::string::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    }
+    // IPv6 в квадратных скобках: [::1]:7000
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    if (port.empty() || port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoi(port) == 0 || std::stoi(port) > 65535) {
+        error = "некорректный адрес: " + address;
+        return -1;
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen ? AI_PASSIVE : 0;
+    addrinfo* results = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0) {
+        error = "не удалось разрешить адрес: " + address;
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* info = results; info && fd < 0; info = info->ai_next) {
+        fd = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int reuse = 1;
+        bool ok = listen ? ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0 &&
+                           ::bind(fd, info->ai_addr, info->ai_addrlen) == 0 && ::listen(fd, 64) == 0
+                         : ::connect(fd, info->ai_addr, info->ai_addrlen) == 0;
+        if (!ok) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(results);
+    if (fd < 0) {
+        error = "не удалось " + std::string(listen ? "открыть порт" : "подключиться к") + " " + address;
+    }
+    return fd;
+}
+
+// Соединение кластера: чтение строк в одном потоке и потокобезопасная запись строк
+class ClusterConnection {
+public:
+    static constexpr size_t MAX_LINE = 1 << 20;
+
+    explicit ClusterConnection(int fd) : fd(fd) {}
+    ~ClusterConnection() { ::close(fd); }
+
+    ClusterConnection(const ClusterConnection&) = delete;
+    ClusterConnection& operator=(const ClusterConnection&) = delete;
+
+    bool send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::string data = line + "\n";
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                // Ошибка или истек таймаут записи: соединение больше не годится
+                shutdown();
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // false - соединение закрыто или строка слишком длинная
+    bool readLine(std::string& line) {
+        while (true) {
+            size_t newline = buffer.find('\n');
+            if (newline != std::string::npos) {
+                line = buffer.substr(0, newline);
+                buffer.erase(0, newline + 1);
+                return true;
+            }
+            if (buffer.size() > MAX_LINE) {
+                return false;
+            }
+            char chunk[4096];
+            ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+    // Прерывает чтение и запись в других потоках; дескриптор закрывается в деструкторе
+    void shutdown() { ::shutdown(fd, SHUT_RDWR); }
+
+    // Таймаут записи: зависший получатель не должен блокировать отправителя
+    void setSendTimeout(int seconds) {
+        timeval timeout{seconds, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+
+private:
+    int fd;
+    std::mutex writeMutex;
+    std::string buffer;
+};
+
+// Координатор: своего пула потоков у него нет, задача выполняется рабочими процессами.
+// Попытки рабочих суммируются в счетчик задачи, совпадения проходят через SearchJob::checkAddress,
+// завершенные аренды отмечаются в разбиении (и попадают в контрольную точку)
+class ClusterCoordinator {
+public:
+    static constexpr unsigned LEASE_CHUNKS_PER_THREAD = 4;  // Блоков в аренде на поток рабочего
+    static constexpr size_t LEASES_AHEAD = 2;               // Аренд у рабочего: текущая и следующая
+    static constexpr double STALL_SECONDS = 15;             // Без отчетов дольше - рабочий отключается
+    static constexpr double SLOW_FACTOR = 4;                // Аренда дольше SLOW_FACTOR ожидаемого - отзывается
+    static constexpr double SLOW_GRACE_SECONDS = 10;
+    static constexpr double RATE_SMOOTHING = 0.3;           // Вес нового замера в скорости рабочего
+    static constexpr double FINAL_REPORT_SECONDS = 3;       // Ожидание итогов рабочих после отмены
+
+    // jobFields - поля задачи для рабочих в формате запроса сервера задач ("prefix": "ab", ...)
+    ClusterCoordinator(std::shared_ptr<SearchJob> job, std::shared_ptr<KeyspacePartition> partition,
+                       std::string jobFields, AddressVerifier verify, std::ostream& log)
+        : job(std::move(job)), partition(std::move(partition)), jobFields(std::move(jobFields)),
+          verify(std::move(verify)), log(log) {
+        chunkAddresses = KeyspacePartition::CHUNK_KEYS * (this->job->splitKey() ? 1 : SYMMETRY_VARIANTS);
+        basePoint = secp256k1::toAffine(secp256k1::addMixed(
+            secp256k1::multiplyGeneratorFixed(this->partition->baseScalar()), this->job->basePoint));
+    }
+
+    ~ClusterCoordinator() {
+        job->stop(StopReason::Cancelled);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& [id, worker] : workers) {
+                worker->connection->shutdown();
+            }
+        }
+        wakeCondition.notify_all();
+        if (listenFd >= 0) {
+            ::shutdown(listenFd, SHUT_RDWR);
+        }
+        if (monitorThread.joinable()) monitorThread.join();
+        if (acceptThread.joinable()) acceptThread.join();
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        if (listenFd >= 0) {
+            ::close(listenFd);
+        }
+        if (address.find('/') != std::string::npos) {
+            ::unlink(address.c_str());
+        }
+    }
+
+    ClusterCoordinator(const ClusterCoordinator&) = delete;
+    ClusterCoordinator& operator=(const ClusterCoordinator&) = delete;
+
+    bool listen(const std::string& listenAddress, std::string& error) {
+        address = listenAddress;
+        listenFd = clusterSocket(address, true, error);
+        return listenFd >= 0;
+    }
+
+    // Запуск задачи: прием рабочих и контроль аренд, пока задача не остановится.
+    // По остановке рабочим рассылается отмена и вызывается onFinish задачи
+    void start() {
+        job->start(1);
+        acceptThread = std::thread(&ClusterCoordinator::acceptLoop, this);
+        monitorThread = std::thread(&ClusterCoordinator::monitorLoop, this);
+    }
+
+    // Подключенные рабочие, получающие аренды
+    size_t workerCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = 0;
+        for (auto& [id, worker] : workers) {
+            count += worker->active;
+        }
+        return count;
+    }
+
+    // Суммарная скорость рабочих, адресов/сек
+    double rate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        double total = 0;
+        for (auto& [id, worker] : workers) {
+            if (worker->active) total += worker->rate;
+        }
+        return total;
+    }
+
+    // Вклад каждого рабочего за время задачи
+    void printSummary(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [id, worker] : workers) {
+            if (worker->threads == 0) continue;
+            out << "Рабочий " << worker->name << ": потоков " << worker->threads << ", адресов "
+                << worker->attempts << ", блоков " << worker->chunksDone << ", скорость "
+                << static_cast<long long>(worker->rate) << " адр/сек" << std::endl;
+        }
+    }
+
+private:
+    struct Lease {
+        uint64_t id = 0;
+        uint64_t first = 0;
+        uint64_t count = 0;
+        std::chrono::steady_clock::time_point since;  // Когда аренда стала текущей у рабочего
+    };
+
+    struct Worker {
+        unsigned int id = 0;
+        std::string name;
+        std::shared_ptr<ClusterConnection> connection;
+        unsigned int threads = 0;
+        bool active = false;  // Готов получать аренды
+        bool connected = true;
+        bool finished = false;  // Прислал done: его попытки учтены полностью
+        uint64_t attempts = 0;
+        double rate = 0;
+        uint64_t chunksDone = 0;
+        std::chrono::steady_clock::time_point lastReport;
+        std::deque<Lease> leases;
+    };
+
+    std::shared_ptr<SearchJob> job;
+    std::shared_ptr<KeyspacePartition> partition;
+    std::string jobFields;
+    AddressVerifier verify;
+    std::ostream& log;
+    uint64_t chunkAddresses = 0;
+    secp256k1::AffinePoint basePoint;  // B*G или Q + B*G - все, что рабочие знают о ключах
+    std::string address;
+    int listenFd = -1;
+
+    // Все поля ниже защищены mutex (порядок блокировок: mutex координатора, затем mutex задачи)
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    bool stopping = false;
+    std::map<unsigned int, std::shared_ptr<Worker>> workers;
+    unsigned int nextWorkerId = 1;
+    uint64_t nextLeaseId = 1;
+    std::deque<std::pair<uint64_t, uint64_t>> requeued;  // Возвращенные диапазоны блоков (первый, количество)
+    std::vector<std::thread> readers;
+
+    std::thread acceptThread;
+    std::thread monitorThread;
+
+    void acceptLoop() {
+        while (true) {
+            sockaddr_storage peer{};
+            socklen_t peerSize = sizeof(peer);
+            int fd = ::accept(listenFd, reinterpret_cast<sockaddr*>(&peer), &peerSize);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                if (fd >= 0) ::close(fd);
+                return;
+            }
+            if (fd < 0) {
+                continue;
+            }
+            auto worker = std::make_shared<Worker>();
+            worker->id = nextWorkerId++;
+            worker->connection = std::make_shared<ClusterConnection>(fd);
+            worker->connection->setSendTimeout(5);
+            char host[NI_MAXHOST] = "local";
+            if (peer.ss_family != AF_UNIX) {
+                ::getnameinfo(reinterpret_cast<sockaddr*>(&peer), peerSize, host, sizeof(host),
+                              nullptr, 0, NI_NUMERICHOST);
+            }
+            worker->name = std::string(host) + "#" + std::to_string(worker->id);
+            worker->lastReport = std::chrono::steady_clock::now();
+            workers[worker->id] = worker;
+            readers.emplace_back(&ClusterCoordinator::serveWorker, this, worker);
+        }
+    }
+
+    void serveWorker(std::shared_ptr<Worker> worker) {
+        std::string line;
+        while (worker->connection->readLine(line)) {
+            handleMessage(*worker, line);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (worker->active && !stopping) {
+            log << "\nРабочий " << worker->name << " отключился" << std::endl;
+        }
+        worker->connected = false;
+        dropWorker(*worker);
+        wakeCondition.notify_all();
+    }
+
+    void handleMessage(Worker& worker, const std::string& line) {
+        std::map<std::string, JsonValue> fields;
+        std::string error;
+        if (!parseJsonLine(line, fields, error)) {
+            return;
+        }
+        std::string event = fields["event"].text;
+        if (event == "hit") {
+            // Проверка ключа идет без mutex координатора: onHit задачи может быть долгим
+            handleHit(worker, fields);
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        try {
+            if (event == "ready" && !worker.active && !stopping) {
+                worker.threads = static_cast<unsigned int>(std::clamp(std::stoul(fields["threads"].text), 1ul, 4096ul));
+                worker.active = true;
+                worker.lastReport = now;
+                worker.connection->send("{\"event\": \"job\", \"base_point\": " + jsonString(publicKeyToHex(basePoint)) +
+                                        (jobFields.empty() ? "" : ", " + jobFields) + "}");
+                log << "\nРабочий " << worker.name << " подключен, потоков: " << worker.threads << std::endl;
+                fillLeases(worker);
+            } else if (event == "progress") {
+                recordAttempts(worker, std::stoull(fields["attempts"].text), now);
+            } else if (event == "lease_done") {
+                completeLease(worker, std::stoull(fields["lease"].text));
+                fillLeases(worker);
+            } else if (event == "done") {
+                // Задача рабочего остановилась: по отмене или сама (например, нашла свой
+                // лимит совпадений). Итог попыток - после последнего пакета
+                auto attempts = fields.find("attempts");
+                if (attempts != fields.end()) {
+                    recordAttempts(worker, std::stoull(attempts->second.text), now);
+                }
+                worker.finished = true;
+                dropWorker(worker);
+                wakeCondition.notify_all();
+            }
+        } catch (const std::exception&) {
+            // Некорректное числовое поле: сообщение пропускается
+        }
+    }
+
+    // Адреса с начала задачи рабочего: в задачу идет прирост
+    void recordAttempts(Worker& worker, uint64_t attempts, std::chrono::steady_clock::time_point now) {
+        double seconds = std::chrono::duration<double>(now - worker.lastReport).count();
+        if (attempts > worker.attempts) {
+            uint64_t delta = attempts - worker.attempts;
+            if (seconds > 0) {
+                double sample = delta / seconds;
+                worker.rate = worker.rate == 0 ? sample : worker.rate + RATE_SMOOTHING * (sample - worker.rate);
+            }
+            job->countAttempts(0, static_cast<long long>(delta));
+            worker.attempts = attempts;
+        }
+        worker.lastReport = now;
+    }
+
+    // Совпадение рабочего засчитывается, только если адрес ключа (по независимой
+    // проверке) подходит под задачу; в режиме адресов контрактов - адрес контракта
+    // этого ключа при присланном nonce. Рабочий присылает смещение k от своей базовой
+    // точки и номер симметрии: ключ - B + k с этой симметрией (с разделенным ключом
+    // симметрий нет, а B + k - смещение от Q клиента)
+    void handleHit(Worker& worker, const std::map<std::string, JsonValue>& fields) {
+        auto offsetField = fields.find("offset");
+        auto symmetryField = fields.find("symmetry");
+        size_t symmetry = symmetryField != fields.end()
+                              ? std::strtoull(symmetryField->second.text.c_str(), nullptr, 10) : 0;
+        uint8_t offset[32];
+        std::vector<uint8_t> privateKey(32);
+        secp256k1::Scalar key;
+        AddressBytes addressBytes;
+        uint64_t nonce = 0;
+        if (job->contractNonces > 0) {
+            auto nonceField = fields.find("nonce");
+            nonce = nonceField != fields.end() ? std::strtoull(nonceField->second.text.c_str(), nullptr, 10)
+                                               : job->contractNonces;
+        }
+        bool valid = offsetField != fields.end() && parseHexBytes(offsetField->second.text, offset, 32) &&
+                     symmetry < (job->splitKey() ? 1 : SYMMETRY_VARIANTS);
+        if (valid) {
+            key = KeyWalker::applySymmetry(
+                secp256k1::Scalar::add(partition->baseScalar(), secp256k1::Scalar::fromBytes(offset)), symmetry);
+            key.toBytes(privateKey.data());
+            valid = !key.isZero() && parseHexBytes(verify(privateKey, job->basePublicKey()), addressBytes.data(), 20);
+        }
+        if (valid && job->contractNonces > 0) {
+            valid = nonce < job->contractNonces;
+            addressBytes = contractAddress(addressBytes, nonce);
+        }
+        valid = valid && job->checkAddress(key, addressBytes.data(), nonce);
+        if (!valid) {
+            std::lock_guard<std::mutex> lock(mutex);
+            log << "\nПредупреждение: совпадение от рабочего " << worker.name << " не подтверждено" << std::endl;
+            return;
+        }
+        if (job->stopped.load()) {
+            wakeCondition.notify_all();
+        }
+    }
+
+    // Следующая аренда: сначала возвращенные диапазоны, затем новые блоки разбиения
+    Lease nextLease(uint64_t count) {
+        Lease lease;
+        lease.id = nextLeaseId++;
+        if (!requeued.empty()) {
+            auto& range = requeued.front();
+            lease.first = range.first;
+            lease.count = std::min(range.second, count);
+            range.first += lease.count;
+            range.second -= lease.count;
+            if (range.second == 0) {
+                requeued.pop_front();
+            }
+            return lease;
+        }
+        // После возобновления блоки идут с пропусками: аренда - только непрерывный диапазон
+        partition->claim(lease.first);
+        lease.count = 1;
+        while (lease.count < count) {
+            uint64_t chunk;
+            partition->claim(chunk);
+            if (chunk != lease.first + lease.count) {
+                requeued.push_back({chunk, 1});
+                break;
+            }
+            lease.count++;
+        }
+        return lease;
+    }
+
+    void fillLeases(Worker& worker) {
+        while (worker.active && worker.leases.size() < LEASES_AHEAD && !job->stopped.load()) {
+            Lease lease = nextLease(static_cast<uint64_t>(worker.threads) * LEASE_CHUNKS_PER_THREAD);
+            lease.since = std::chrono::steady_clock::now();
+            worker.leases.push_back(lease);
+            worker.connection->send("{\"event\": \"lease\", \"lease\": " + std::to_string(lease.id) +
+                                    ", \"first\": " + std::to_string(lease.first) +
+                                    ", \"count\": " + std::to_string(lease.count) + "}");
+        }
+    }
+
+    void completeLease(Worker& worker, uint64_t leaseId) {
+        auto found = std::find_if(worker.leases.begin(), worker.leases.end(),
+                                  [leaseId](const Lease& lease) { return lease.id == leaseId; });
+        if (found == worker.leases.end()) {
+            return;
+        }
+        for (uint64_t i = 0; i < found->count; i++) {
+            partition->complete(found->first + i);
+        }
+        worker.chunksDone += found->count;
+        bool wasCurrent = found == worker.leases.begin();
+        worker.leases.erase(found);
+        if (wasCurrent && !worker.leases.empty()) {
+            worker.leases.front().since = std::chrono::steady_clock::now();
+        }
+    }
+
+    // Рабочий больше не получает аренды, его незавершенные аренды возвращаются в очередь
+    void dropWorker(Worker& worker) {
+        worker.active = false;
+        for (auto lease = worker.leases.rbegin(); lease != worker.leases.rend(); ++lease) {
+            requeued.push_front({lease->first, lease->count});
+        }
+        worker.leases.clear();
+    }
+
+    // Раз в секунду (и сразу после совпадения): таймаут задачи, зависшие рабочие
+    // и застрявшие аренды; после остановки задачи - отмена у всех рабочих
+    void monitorLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!job->stopped.load()) {
+            wakeCondition.wait_for(lock, std::chrono::seconds(1));
+            auto now = std::chrono::steady_clock::now();
+            if (job->timeoutSeconds > 0 && now >= job->deadline) {
+                job->stop(StopReason::Timeout);
+            }
+            for (auto& [id, worker] : workers) {
+                if (!worker->active) {
+                    continue;
+                }
+                if (std::chrono::duration<double>(now - worker->lastReport).count() > STALL_SECONDS) {
+                    log << "\nРабочий " << worker->name << " не отвечает, его блоки переданы другим" << std::endl;
+                    dropWorker(*worker);
+                    worker->connection->shutdown();
+                    continue;
+                }
+                // Текущая аренда идет намного дольше, чем обещает скорость рабочего
+                if (!worker->leases.empty() && worker->rate > 0) {
+                    const Lease& lease = worker->leases.front();
+                    double expected = static_cast<double>(lease.count * chunkAddresses) / worker->rate;
+                    if (std::chrono::duration<double>(now - lease.since).count() >
+                        SLOW_FACTOR * expected + SLOW_GRACE_SECONDS) {
+                        worker->connection->send("{\"event\": \"revoke\", \"lease\": " + std::to_string(lease.id) + "}");
+                        requeued.push_front({lease.first, lease.count});
+                        worker->leases.pop_front();
+                        if (!worker->leases.empty()) {
+                            worker->leases.front().since = now;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Задача выполнена, истекло время или отменена: рабочие больше не нужны.
+        // Итог задачи ждет их последних попыток (done), но не дольше FINAL_REPORT_SECONDS
+        stopping = true;
+        for (auto& [id, worker] : workers) {
+            worker->connection->send("{\"event\": \"cancel\"}");
+        }
+        wakeCondition.wait_for(lock, std::chrono::duration<double>(FINAL_REPORT_SECONDS), [this] {
+            return std::all_of(workers.begin(), workers.end(), [](const auto& entry) {
+                const Worker& worker = *entry.second;
+                return worker.threads == 0 || worker.finished || !worker.connected;
+            });
+        });
+        for (auto& [id, worker] : workers) {
+            worker->connection->shutdown();
+        }
+        lock.unlock();
+        job->finish();
+    }
+};
+
+// Рабочий процесс: подключается к координатору (ждет его, если тот еще не запущен),
+// получает задачу и обходит арендованные блоки своим пулом потоков
+class ClusterWorker {
+public:
+    static constexpr double RETRY_SECONDS = 2;
+    static constexpr double PROGRESS_SECONDS = 1;
+
+    ClusterWorker(SearchPool& pool, AddressVerifier verify) : pool(pool), verify(std::move(verify)) {}
+
+    // Работа до отмены задачи или отключения координатора; код завершения процесса
+    int run(const std::string& address) {
+        std::string error;
+        int fd;
+        bool waiting = false;
+        while ((fd = clusterSocket(address, false, error)) < 0) {
+            if (error.rfind("некорректный", 0) == 0) {
+                std::cerr << "Ошибка: " << error << std::endl;
+                return 1;
+            }
+            if (!waiting) {
+                std::cerr << "Ожидание координатора: " << error << std::endl;
+                waiting = true;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(RETRY_SECONDS));
+        }
+        connection = std::make_shared<ClusterConnection>(fd);
+        std::cerr << "Подключен к координатору " << address << ", потоков: " << pool.threadCount() << std::endl;
+        connection->send("{\"event\": \"ready\", \"threads\": " + std::to_string(pool.threadCount()) + "}");
+
+        int status = 0;
+        std::string line;
+        while (connection->readLine(line)) {
+            if (!handleMessage(line)) {
+                status = 1;
+                break;
+            }
+        }
+
+        // Координатор закрыл соединение или прислал отмену: задача больше не нужна
+        if (job) {
+            job->stop(StopReason::Cancelled);
+            job->wait();
+            std::cerr << "Задача завершена: " << stopReasonName(job->reason) << ", адресов: "
+                      << job->attemptCount() << std::endl;
+        }
+        if (reporter.joinable()) {
+            reporter.join();
+        }
+        return status;
+    }
+
+private:
+    // Аренда на стороне рабочего. Отозванная аренда больше не выдает блоки и удаляется,
+    // когда завершатся уже выданные
+    struct Lease {
+        uint64_t id = 0;
+        uint64_t first = 0;
+        uint64_t count = 0;
+        uint64_t claimed = 0;
+        uint64_t completed = 0;
+        bool revoked = false;
+    };
+
+    SearchPool& pool;
+    AddressVerifier verify;
+    std::shared_ptr<ClusterConnection> connection;
+    std::shared_ptr<SearchJob> job;
+    std::thread reporter;
+
+    std::mutex mutex;
+    std::condition_variable leaseCondition;
+    std::deque<Lease> leases;  // Защищено mutex
+
+    // false - задачу выполнить нельзя
+    bool handleMessage(const std::string& line) {
+        std::map<std::string, JsonValue> fields;
+        std::string error;
+        if (!parseJsonLine(line, fields, error)) {
+            return true;
+        }
+        std::string event = fields["event"].text;
+        try {
+            if (event == "job" && !job) {
+                return startJob(fields);
+            } else if (event == "lease") {
+                Lease lease;
+                lease.id = std::stoull(fields["lease"].text);
+                lease.first = std::stoull(fields["first"].text);
+                lease.count = std::stoull(fields["count"].text);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    leases.push_back(lease);
+                }
+                leaseCondition.notify_all();
+            } else if (event == "revoke") {
+                uint64_t id = std::stoull(fields["lease"].text);
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+                    if (lease->id == id) {
+                        lease->revoked = true;
+                        if (lease->completed == lease->claimed) {
+                            leases.erase(lease);
+                        }
+                        break;
+                    }
+                }
+            } else if (event == "cancel" && job) {
+                job->stop(StopReason::Cancelled);
+            }
+        } catch (const std::exception&) {
+            // Некорректное числовое поле: сообщение пропускается
+        }
+        return true;
+    }
+
+    bool startJob(std::map<std::string, JsonValue>& fields) {
+        secp256k1::AffinePoint basePoint;
+        std::string error;
+        if (!parsePublicKeyHex(fields["base_point"].text, basePoint, error)) {
+            std::cerr << "Ошибка: координатор прислал некорректную задачу" << std::endl;
+            return false;
+        }
+        fields.erase("event");
+        fields.erase("base_point");
+        auto newJob = std::make_shared<SearchJob>();
+        if (!buildJob(fields, *newJob, error)) {
+            std::cerr << "Ошибка: задача координатора: " << error << std::endl;
+            return false;
+        }
+        // Соли CREATE2 не делятся на блоки ключей
+        if (newJob->kind == SearchKind::Create2) {
+            std::cerr << "Ошибка: задача координатора: CREATE2 в кластере не поддерживается" << std::endl;
+            return false;
+        }
+
+        // Обход от точки координатора: с разделенным ключом она уже включает Q клиента,
+        // иначе ее скаляр знает координатор, и симметрии остаются
+        newJob->baseSymmetries = !newJob->splitKey();
+        newJob->basePoint = basePoint;
+
+        // Блоки берутся из арендованных диапазонов, а не из собственного счетчика;
+        // ключи блоков - смещения от точки координатора
+        auto partition = KeyspacePartition::withBase(secp256k1::Scalar::zero());
+        partition->source = [this](uint64_t& chunk) { return nextChunk(chunk); };
+        partition->onComplete = [this](uint64_t chunk) { chunkDone(chunk); };
+        newJob->partition = partition;
+        newJob->onHit = [this](const SearchJob& job, const SearchHit& hit) {
+            // Прогресс перед совпадением: координатор может остановить задачу сразу после него
+            connection->send("{\"event\": \"progress\", \"attempts\": " + std::to_string(job.attemptCount()) + "}");
+            connection->send(hitToJson(job, hit, verify));
+        };
+        newJob->onFinish = [this](const SearchJob& job) {
+            connection->send("{\"event\": \"done\", \"attempts\": " + std::to_string(job.attemptCount()) + "}");
+        };
+        job = newJob;
+        pool.submit(job);
+
+        reporter = std::thread([this] {
+            while (!job->stopped.load()) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(PROGRESS_SECONDS));
+                connection->send("{\"event\": \"progress\", \"attempts\": " +
+                                 std::to_string(job->attemptCount()) + "}");
+            }
+        });
+        return true;
+    }
+
+    // Источник блоков для потоков пула: ждет аренду, пока задача не остановлена
+    bool nextChunk(uint64_t& chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!job->stopped.load()) {
+            for (Lease& lease : leases) {
+                if (!lease.revoked && lease.claimed < lease.count) {
+                    chunk = lease.first + lease.claimed++;
+                    return true;
+                }
+            }
+            leaseCondition.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        return false;
+    }
+
+    // Завершенный блок засчитывается самой старой аренде, в которой он выдан и еще не завершен
+    void chunkDone(uint64_t chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+            if (chunk < lease->first || chunk >= lease->first + lease->claimed || lease->completed == lease->claimed) {
+                continue;
+            }
+            lease->completed++;
+            if (lease->revoked ? lease->completed == lease->claimed : lease->completed == lease->count) {
+                if (!lease->revoked) {
+                    connection->send("{\"event\": \"lease_done\", \"lease\": " + std::to_string(lease->id) + "}");
+                }
+                leases.erase(lease);
+            }
+            return;
+        }
+    }
+};
+
+#endif // _WIN32
+
+#endif // CLUSTER_H
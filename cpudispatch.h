@@ -0,0 +1,110 @@
+// Выбор варианта горячих ядер под процессор во время выполнения.
+// Бинарник собирается без флагов архитектуры и содержит три варианта ядер:
+// generic - базовый код для любой платформы, avx2 - AVX2 + BMI2 (Keccak по 4 лейна,
+// арифметика поля с MULX), avx512 - AVX-512F + BMI2 + ADX (Keccak по 8 лейнов).
+// Вариант определяется один раз по cpuid при первом обращении и может быть
+// задан явно (--cpu-variant) для тестов и сравнения.
+
+#ifndef CPUDISPATCH_H
+#define CPUDISPATCH_H
+
+#include <atomic>
+#include <string>
+
+// Варианты под расширения x86 собираются атрибутом target (GCC/Clang)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH_X86 1
+#include <cpuid.h>
+#endif
+
+enum class CpuVariant : int {
+    Generic,
+    Avx2,
+    Avx512
+};
+
+inline const char* cpuVariantName(CpuVariant variant) {
+    switch (variant) {
+    case CpuVariant::Generic: return "generic";
+    case CpuVariant::Avx2: return "avx2";
+    case CpuVariant::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+// Расширения, на которые опирается вариант, для баннера
+inline const char* cpuVariantFeatures(CpuVariant variant) {
+    switch (variant) {
+    case CpuVariant::Generic: return "без расширений";
+    case CpuVariant::Avx2: return "AVX2, BMI2";
+    case CpuVariant::Avx512: return "AVX-512F, BMI2, ADX";
+    }
+    return "";
+}
+
+inline bool parseCpuVariant(const std::string& name, CpuVariant& variant) {
+    for (CpuVariant v : {CpuVariant::Generic, CpuVariant::Avx2, CpuVariant::Avx512}) {
+        if (name == cpuVariantName(v)) {
+            variant = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Поддерживает ли процессор (и ОС - сохранение регистров AVX) вариант
+inline bool cpuSupportsVariant(CpuVariant variant) {
+    if (variant == CpuVariant::Generic) {
+        return true;
+    }
+#ifdef CPU_DISPATCH_X86
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi2")) {
+        return false;
+    }
+    if (variant == CpuVariant::Avx2) {
+        return true;
+    }
+    // ADX: cpuid leaf 7, EBX бит 19
+    unsigned int eax, ebx, ecx, edx;
+    bool adx = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 19)) != 0;
+    return __builtin_cpu_supports("avx512f") && adx;
+#else
+    return false;
+#endif
+}
+
+// Лучший вариант, который поддерживает процессор
+inline CpuVariant detectCpuVariant() {
+    if (cpuSupportsVariant(CpuVariant::Avx512)) {
+        return CpuVariant::Avx512;
+    }
+    if (cpuSupportsVariant(CpuVariant::Avx2)) {
+        return CpuVariant::Avx2;
+    }
+    return CpuVariant::Generic;
+}
+
+// -1 - еще не определен
+inline std::atomic<int> selectedCpuVariant{-1};
+
+// Вариант ядер текущего процесса; одна загрузка в горячем цикле
+inline CpuVariant activeCpuVariant() {
+    int value = selectedCpuVariant.load(std::memory_order_relaxed);
+    if (value < 0) {
+        value = static_cast<int>(detectCpuVariant());
+        selectedCpuVariant.store(value, std::memory_order_relaxed);
+    }
+    return static_cast<CpuVariant>(value);
+}
+
+// Явный выбор варианта до запуска потоков; false, если процессор его не поддерживает
+inline bool forceCpuVariant(CpuVariant variant) {
+    if (!cpuSupportsVariant(variant)) {
+        return false;
+    }
+    selectedCpuVariant.store(static_cast<int>(variant), std::memory_order_relaxed);
+    return true;
+}
+
+#endif // CPUDISPATCH_H
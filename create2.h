@@ -0,0 +1,169 @@
+// Адреса контрактов CREATE2: keccak256(0xff ++ deployer ++ salt ++ keccak256(init_code))[12:].
+// Деплоер и хеш init-кода фиксированы, перебирается 32-байтная соль, поэтому кривая
+// не нужна вовсе: один Keccak-f на кандидата. Вход - ровно 85 байт (один блок), и
+// соседние кандидаты отличаются только счетчиком в байтах 3..10 соли: постоянная
+// часть поглощается один раз на пакет (см. Keccak::create2AddressBatch).
+
+#ifndef CREATE2_H
+#define CREATE2_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "keccak.h"
+#include "address.h"
+#include "csprng.h"
+
+using Salt = std::array<uint8_t, 32>;
+
+// Параметры CREATE2: адрес деплоера (фабрики) и keccak256 от init-кода контракта
+struct Create2Params {
+    AddressBytes deployer{};
+    std::array<uint8_t, 32> initCodeHash{};
+
+    // 85 байт входа Keccak для соли salt
+    void input(const Salt& salt, uint8_t out[Keccak::CREATE2_INPUT_BYTES]) const {
+        out[0] = 0xff;
+        std::memcpy(out + 1, deployer.data(), 20);
+        std::memcpy(out + 21, salt.data(), 32);
+        std::memcpy(out + 53, initCodeHash.data(), 32);
+    }
+};
+
+inline bool parseCreate2Params(const std::string& deployerHex, const std::string& initCodeHashHex,
+                               Create2Params& params, std::string& error) {
+    if (!parseHexBytes(deployerHex, params.deployer.data(), 20)) {
+        error = "адрес деплоера должен быть 20 байт в hex";
+        return false;
+    }
+    if (!parseHexBytes(initCodeHashHex, params.initCodeHash.data(), 32)) {
+        error = "хеш init-кода должен быть 32 байта в hex";
+        return false;
+    }
+    return true;
+}
+
+// Адрес контракта для одной соли: общий Keccak-256 без пакетной специализации,
+// независимая проверка найденных солей
+inline AddressBytes create2Address(const Create2Params& params, const Salt& salt) {
+    uint8_t input[Keccak::CREATE2_INPUT_BYTES];
+    params.input(salt, input);
+    uint8_t hash[32];
+    Keccak::keccak256(input, sizeof(input), hash);
+    AddressBytes address;
+    std::memcpy(address.data(), hash + 12, 20);
+    return address;
+}
+
+inline std::string saltToHex(const Salt& salt) {
+    std::string out = "0x";
+    for (uint8_t byte : salt) {
+        out += hexChars[byte >> 4];
+        out += hexChars[byte & 0x0F];
+    }
+    return out;
+}
+
+// Обход солей пакетами по batchSize: случайная соль, счетчик в байтах 3..10 соли
+// (little-endian, лейн 3 входа) растет на 1 на кандидата. Интерфейс пакета - как у
+// KeyWalker: адреса подряд и битовая карта совпадений, соль восстанавливается по индексу
+class SaltWalker {
+public:
+    static constexpr size_t COUNTER_OFFSET = 3;  // Байты соли под счетчик
+
+    explicit SaltWalker(size_t batchSize = WALK_BATCH_SIZE)
+        : size(batchSize), addresses(batchSize * 20), matches(batchSize / 64) {}
+
+    // Отметки стадий пакета для профилирования (см. profile.h); nullptr - без отметок
+    void setStageTimer(StageTimer* stageTimer) {
+        timer = stageTimer;
+    }
+
+    StageTimer* stageTimer() const {
+        return timer;
+    }
+
+    // Фильтр маски в Keccak, как у KeyWalker::setAddressFilter
+    void setAddressFilter(const Keccak::AddressFilter* addressFilter) {
+        filter = addressFilter;
+    }
+
+    bool filtered() const {
+        return filter != nullptr;
+    }
+
+    void setParams(const Create2Params& params) {
+        this->params = params;
+    }
+
+    size_t batchSize() const {
+        return size;
+    }
+
+    size_t addressCount() const {
+        return size;
+    }
+
+    // Один Keccak-256 на соль
+    size_t hashCount() const {
+        return size;
+    }
+
+    // Начало обхода со случайной соли
+    void start(SecureRandom& rng) {
+        rng.fill(salt.data(), salt.size());
+        std::memcpy(&counter, salt.data() + COUNTER_OFFSET, 8);
+        params.input(salt, input);
+    }
+
+    // Адреса солей со счетчиками counter .. counter + batchSize - 1.
+    // false, если счетчик переполнился бы внутри пакета: нужна новая соль
+    bool computeBatch() {
+        if (counter > UINT64_MAX - size) {
+            return false;
+        }
+        if (timer) {
+            timer->begin(ProfileStage::Keccak);
+        }
+        Keccak::create2AddressBatch(input, counter, addresses.data(), size, filter, matches.data());
+        return true;
+    }
+
+    void advance() {
+        counter += size;
+    }
+
+    const uint8_t* address(size_t i) const {
+        return addresses.data() + i * 20;
+    }
+
+    uint64_t* matchBitmap() {
+        return matches.data();
+    }
+
+    // Соль i-го адреса пакета
+    Salt saltAt(size_t i) const {
+        Salt result = salt;
+        uint64_t value = counter + i;
+        for (size_t j = 0; j < 8; j++) {
+            result[COUNTER_OFFSET + j] = static_cast<uint8_t>(value >> (j * 8));
+        }
+        return result;
+    }
+
+private:
+    size_t size;
+    Create2Params params;
+    Salt salt{};
+    uint64_t counter = 0;
+    uint8_t input[Keccak::CREATE2_INPUT_BYTES] = {};
+    std::vector<uint8_t> addresses;
+    std::vector<uint64_t> matches;
+    StageTimer* timer = nullptr;
+    const Keccak::AddressFilter* filter = nullptr;
+};
+
+#endif // CREATE2_H
@@ -0,0 +1,261 @@
+// Криптостойкий источник приватных ключей
+// ChaCha20 с ключом из энтропии ОС (getrandom / getentropy / BCryptGenRandom)
+// генерирует поток блоками по 64 КБ; ключи выдаются из буфера без системных
+// вызовов и блокировок. После каждого заполнения буфера ключ ChaCha20 заменяется
+// первыми 32 байтами нового потока (fast key erasure), выданные байты стираются,
+// поэтому утечка состояния не раскрывает уже выданные ключи. Раз в RESEED_REFILLS
+// заполнений в ключ подмешивается свежая энтропия ОС.
+// Каждый поток держит свой экземпляр: класс не потокобезопасен.
+
+#ifndef CSPRNG_H
+#define CSPRNG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <bcrypt.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "bcrypt.lib")
+#endif
+#elif defined(__linux__)
+#include <cerrno>
+#include <sys/random.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "secp256k1.h"
+#include "cpudispatch.h"
+
+// 8 блоков ChaCha20 считаются векторными расширениями GCC/Clang (на x86
+// дополнительно вариант с атрибутом target("avx2") для вариантов ядер avx2 и avx512),
+// иначе - по одному блоку
+#if defined(__GNUC__) || defined(__clang__)
+#define CSPRNG_HAVE_VECTOR_LANES 1
+#define CSPRNG_INLINE inline __attribute__((always_inline))
+#if defined(__x86_64__) || defined(__i386__)
+#define CSPRNG_HAVE_AVX2 1
+#endif
+#else
+#define CSPRNG_INLINE inline
+#endif
+
+// Энтропия операционной системы; false, если источник недоступен
+inline bool osRandomBytes(uint8_t* out, size_t size) {
+#ifdef _WIN32
+    return BCryptGenRandom(nullptr, out, static_cast<ULONG>(size), BCRYPT_USE_SYSTEM_PREFERRED_RNG) == 0;
+#elif defined(__linux__)
+    while (size > 0) {
+        ssize_t n = getrandom(out, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+#else
+    // getentropy выдает не более 256 байт за вызов
+    while (size > 0) {
+        size_t chunk = size < 256 ? size : 256;
+        if (getentropy(out, chunk) != 0) {
+            return false;
+        }
+        out += chunk;
+        size -= chunk;
+    }
+    return true;
+#endif
+}
+
+class SecureRandom {
+public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+    static constexpr unsigned RESEED_REFILLS = 1024;  // 64 МБ потока
+
+    // Ключ из энтропии ОС. Без энтропии генерировать приватные ключи нельзя,
+    // поэтому при ее отсутствии программа завершается
+    SecureRandom() {
+        if (!osRandomBytes(reinterpret_cast<uint8_t*>(key), sizeof(key))) {
+            std::fprintf(stderr, "Ошибка: источник энтропии ОС недоступен\n");
+            std::abort();
+        }
+    }
+
+    // Детерминированный поток из seed - только для бенчмарков, не для настоящих ключей
+    explicit SecureRandom(uint64_t seed) : reseed(false) {
+        std::memset(key, 0, sizeof(key));
+        std::memcpy(key, &seed, sizeof(seed));
+    }
+
+    SecureRandom(const SecureRandom&) = delete;
+    SecureRandom& operator=(const SecureRandom&) = delete;
+
+    ~SecureRandom() {
+        wipe(key, sizeof(key));
+        wipe(buffer, sizeof(buffer));
+    }
+
+    void fill(uint8_t* out, size_t size) {
+        while (size > 0) {
+            if (position == BUFFER_SIZE) {
+                refill();
+            }
+            size_t chunk = BUFFER_SIZE - position < size ? BUFFER_SIZE - position : size;
+            std::memcpy(out, buffer + position, chunk);
+            std::memset(buffer + position, 0, chunk);
+            position += chunk;
+            out += chunk;
+            size -= chunk;
+        }
+    }
+
+    // Равномерный скаляр в [1, n-1]: 32 байта, значения 0 и >= n отбрасываются
+    // (вероятность отбросить ~2^-128)
+    secp256k1::Scalar nextScalar() {
+        uint8_t bytes[32];
+        secp256k1::Scalar k;
+        do {
+            fill(bytes, sizeof(bytes));
+        } while (!secp256k1::Scalar::fromBytesChecked(bytes, k));
+        wipe(bytes, sizeof(bytes));
+        return k;
+    }
+
+    // Приватный ключ в 32-байтный буфер (big-endian), диапазон как у nextScalar
+    void nextPrivateKey(uint8_t* out) {
+        nextScalar().toBytes(out);
+    }
+
+private:
+    // Блоков ChaCha20 за один проход
+    static constexpr size_t LANES = 8;
+#ifdef CSPRNG_HAVE_VECTOR_LANES
+    typedef uint32_t Lanes8 __attribute__((vector_size(32)));
+#endif
+
+    uint32_t key[8];
+    uint8_t buffer[BUFFER_SIZE];
+    size_t position = BUFFER_SIZE;
+    unsigned refills = 0;
+    bool reseed = true;
+
+    static void wipe(void* data, size_t size) {
+        volatile uint8_t* p = static_cast<volatile uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            p[i] = 0;
+        }
+    }
+
+    // N блоков ChaCha20 (20 раундов) со счетчиками counter .. counter + N - 1.
+    // Lanes - uint32_t (N = 1) или вектор из N слов: блоки считаются параллельно
+    template<typename Lanes, size_t N>
+    static CSPRNG_INLINE void chachaLanes(const uint32_t key[8], uint64_t counter, uint8_t* out) {
+        static constexpr uint32_t SIGMA[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+        uint32_t words[16][N];
+        for (size_t l = 0; l < N; l++) {
+            for (int i = 0; i < 4; i++) words[i][l] = SIGMA[i];
+            for (int i = 0; i < 8; i++) words[4 + i][l] = key[i];
+            words[12][l] = static_cast<uint32_t>(counter + l);
+            words[13][l] = static_cast<uint32_t>((counter + l) >> 32);
+            words[14][l] = 0;
+            words[15][l] = 0;
+        }
+        Lanes input[16], x[16];
+        std::memcpy(input, words, sizeof(input));
+        std::memcpy(x, words, sizeof(x));
+
+        auto quarter = [&x](int a, int b, int c, int d) {
+            x[a] += x[b]; x[d] ^= x[a]; x[d] = (x[d] << 16) | (x[d] >> 16);
+            x[c] += x[d]; x[b] ^= x[c]; x[b] = (x[b] << 12) | (x[b] >> 20);
+            x[a] += x[b]; x[d] ^= x[a]; x[d] = (x[d] << 8) | (x[d] >> 24);
+            x[c] += x[d]; x[b] ^= x[c]; x[b] = (x[b] << 7) | (x[b] >> 25);
+        };
+        for (int round = 0; round < 10; round++) {
+            quarter(0, 4, 8, 12);
+            quarter(1, 5, 9, 13);
+            quarter(2, 6, 10, 14);
+            quarter(3, 7, 11, 15);
+            quarter(0, 5, 10, 15);
+            quarter(1, 6, 11, 12);
+            quarter(2, 7, 8, 13);
+            quarter(3, 4, 9, 14);
+        }
+        for (int i = 0; i < 16; i++) {
+            x[i] += input[i];
+        }
+
+        std::memcpy(words, x, sizeof(x));
+        for (size_t l = 0; l < N; l++) {
+            for (int i = 0; i < 16; i++) {
+                uint32_t v = words[i][l];
+                uint8_t* p = out + l * 64 + i * 4;
+                p[0] = static_cast<uint8_t>(v);
+                p[1] = static_cast<uint8_t>(v >> 8);
+                p[2] = static_cast<uint8_t>(v >> 16);
+                p[3] = static_cast<uint8_t>(v >> 24);
+            }
+        }
+    }
+
+    // Весь буфер потоком ChaCha20 с ключом key
+    static void generate(const uint32_t key[8], uint8_t* out) {
+        for (size_t offset = 0; offset < BUFFER_SIZE; offset += LANES * 64) {
+#ifdef CSPRNG_HAVE_VECTOR_LANES
+            chachaLanes<Lanes8, LANES>(key, offset / 64, out + offset);
+#else
+            for (size_t l = 0; l < LANES; l++) {
+                chachaLanes<uint32_t, 1>(key, offset / 64 + l, out + offset + l * 64);
+            }
+#endif
+        }
+    }
+
+#ifdef CSPRNG_HAVE_AVX2
+    __attribute__((target("avx2")))
+    static void generateAvx2(const uint32_t key[8], uint8_t* out) {
+        for (size_t offset = 0; offset < BUFFER_SIZE; offset += LANES * 64) {
+            chachaLanes<Lanes8, LANES>(key, offset / 64, out + offset);
+        }
+    }
+#endif
+
+    void refill() {
+        if (reseed && ++refills == RESEED_REFILLS) {
+            refills = 0;
+            uint32_t fresh[8];
+            if (osRandomBytes(reinterpret_cast<uint8_t*>(fresh), sizeof(fresh))) {
+                for (int i = 0; i < 8; i++) key[i] ^= fresh[i];
+            }
+            wipe(fresh, sizeof(fresh));
+        }
+#ifdef CSPRNG_HAVE_AVX2
+        // Вариант ядер процесса (см. cpudispatch.h), в том числе заданный --cpu-variant
+        if (activeCpuVariant() >= CpuVariant::Avx2) {
+            generateAvx2(key, buffer);
+        } else {
+            generate(key, buffer);
+        }
+#else
+        generate(key, buffer);
+#endif
+        // Первые 32 байта - новый ключ, они не выдаются
+        for (int i = 0; i < 8; i++) {
+            const uint8_t* p = buffer + i * 4;
+            key[i] = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+        std::memset(buffer, 0, sizeof(key));
+        position = sizeof(key);
+    }
+};
+
+#endif // CSPRNG_H
@@ -5,134 +5,651 @@
 #define KECCAK_H
 
 #include <vector>
+#include <array>
+#include <span>
+#include <bit>
+#include <type_traits>
 #include <cstdint>
 #include <cstring>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+#include "cpudispatch.h"
+
+// Многополосные SIMD-ядра собираются через векторные расширения GCC/Clang
+// с атрибутом target, поэтому не требуют глобальных флагов архитектуры
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define KECCAK_HAVE_SIMD_LANES 1
+#endif
+
+// Шаблоны раунда должны встраиваться в функции с атрибутом target,
+// иначе векторные лейны передаются через стек
+#if defined(_MSC_VER) && !defined(__clang__)
+#define KECCAK_INLINE __forceinline
+#else
+#define KECCAK_INLINE inline __attribute__((always_inline))
+#endif
 
 class Keccak {
 private:
     static constexpr int KECCAK_ROUNDS = 24;
-    static constexpr uint64_t ROTL64(uint64_t x, int y) {
-        return (x << y) | (x >> (64 - y));
-    }
-    
-    static void keccakf(uint64_t st[25]) {
-        const uint64_t keccakf_rndc[24] = {
-            0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
-            0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
-            0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
-            0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
-            0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
-            0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
-            0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
-            0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
-        };
+    
+    static constexpr uint64_t ROUND_CONSTANTS[24] = {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+        0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+        0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+        0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+        0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+        0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+        0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+    };
+    
+    // Смещения Rho для лейна x + 5y и позиция лейна после перестановки Pi
+    static constexpr int RHO_OFFSETS[25] = {
+        0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43,
+        25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14
+    };
+    static constexpr int PI_DESTINATION[25] = {
+        0, 10, 20, 5, 15, 16, 1, 11, 21, 6, 7, 17, 2,
+        12, 22, 23, 8, 18, 3, 13, 14, 24, 9, 19, 4
+    };
+    
+    // Раунд над произвольным типом лейна: uint64_t или SIMD-вектор из нескольких лейнов.
+    // Все индексы и сдвиги - константы времени компиляции, раунд развернут полностью
+    template <typename T, int N>
+    static constexpr KECCAK_INLINE void rotlInPlace(T& x) {
+        if constexpr (N != 0) {
+            x = (x << N) | (x >> (64 - N));
+        }
+    }
+    
+    template <typename T, size_t... I>
+    static constexpr KECCAK_INLINE void rhoPi(const T* a, const T* d, T* b, std::index_sequence<I...>) {
+        ((b[PI_DESTINATION[I]] = a[I] ^ d[I % 5],
+          rotlInPlace<T, RHO_OFFSETS[I]>(b[PI_DESTINATION[I]])), ...);
+    }
+    
+    template <typename T, size_t... I>
+    static constexpr KECCAK_INLINE void chi(T* a, const T* b, std::index_sequence<I...>) {
+        ((a[I] = b[I] ^ (~b[(I / 5) * 5 + (I + 1) % 5] & b[(I / 5) * 5 + (I + 2) % 5])), ...);
+    }
+    
+    // Theta, первая половина: четности столбцов
+    template <typename T>
+    static constexpr KECCAK_INLINE void columnParity(const T* a, T* c) {
+        for (int i = 0; i < 5; i++)
+            c[i] = a[i] ^ a[i + 5] ^ a[i + 10] ^ a[i + 15] ^ a[i + 20];
+    }
+    
+    // Остаток раунда по готовым четностям столбцов c: Theta, Rho Pi, Chi, Iota
+    template <typename T>
+    static constexpr KECCAK_INLINE void roundFromParity(T* a, const T* c, int round) {
+        T b[25], d[5];
+        for (int i = 0; i < 5; i++) {
+            d[i] = c[(i + 1) % 5];
+            rotlInPlace<T, 1>(d[i]);
+            d[i] ^= c[(i + 4) % 5];
+        }
         
-        const int keccakf_rotc[24] = {
-            1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
-            27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
-        };
+        rhoPi(a, d, b, std::make_index_sequence<25>());
+        chi(a, b, std::make_index_sequence<25>());
         
-        const int keccakf_piln[24] = {
-            10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
-            15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
-        };
+        a[0] ^= ROUND_CONSTANTS[round];
+    }
+    
+    // Раунды 0..22: последний раунд пакетные ядра считают сами (см. DigestSink, FilterSink)
+    template <typename T>
+    static constexpr KECCAK_INLINE void keccakfHead(T* a) {
+        T c[5];
+        for (int round = 0; round < KECCAK_ROUNDS - 1; round++) {
+            columnParity(a, c);
+            roundFromParity(a, c, round);
+        }
+    }
+    
+    template <typename T>
+    static constexpr KECCAK_INLINE void keccakfLanes(T* a) {
+        keccakfHead(a);
+        T c[5];
+        columnParity(a, c);
+        roundFromParity(a, c, KECCAK_ROUNDS - 1);
+    }
+    
+    // На little-endian платформах во время выполнения - прямая загрузка слова,
+    // при вычислении на этапе компиляции - побайтовая сборка
+    static constexpr KECCAK_INLINE uint64_t loadLE64(const uint8_t* p) {
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+            uint64_t word;
+            memcpy(&word, p, 8);
+            return word;
+        }
+        uint64_t word = 0;
+        for (int j = 0; j < 8; j++) {
+            word |= ((uint64_t)p[j]) << (j * 8);
+        }
+        return word;
+    }
+    
+    static constexpr KECCAK_INLINE void storeLE64(uint8_t* p, uint64_t word) {
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+            memcpy(p, &word, 8);
+            return;
+        }
+        for (int j = 0; j < 8; j++) {
+            p[j] = (word >> (j * 8)) & 0xFF;
+        }
+    }
+    
+    // Поглощение ровно 64 байт: один блок, паддинг 0x01 в лейне 8 и 0x80 в лейне 16
+    static constexpr KECCAK_INLINE void permute64(const uint8_t* input, uint64_t st[25]) {
+        for (int w = 0; w < 8; w++) {
+            st[w] = loadLE64(input + w * 8);
+        }
+        for (int w = 8; w < 25; w++) {
+            st[w] = 0;
+        }
+        st[8] = 0x01;
+        st[16] = 0x8000000000000000ULL;
+        keccakfLanes(st);
+    }
+    
+    // Запись результата: полный хеш (32 байта) или только адрес (байты 12..31 хеша, 20 байт)
+    template <int OUT_BYTES>
+    static constexpr KECCAK_INLINE void storeDigest(uint8_t* out, uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3) {
+        if constexpr (OUT_BYTES == 32) {
+            storeLE64(out, w0);
+            storeLE64(out + 8, w1);
+            storeLE64(out + 16, w2);
+            storeLE64(out + 24, w3);
+        } else {
+            // Байты 12..15 - старшая половина лейна 1
+            uint64_t high = w1 >> 32;
+            for (int j = 0; j < 4; j++) {
+                out[j] = (high >> (j * 8)) & 0xFF;
+            }
+            storeLE64(out + 4, w2);
+            storeLE64(out + 12, w3);
+        }
+    }
+    
+public:
+    // Маска адреса в лейнах 1..3 итогового состояния (байты 12..31 хеша, см. storeDigest):
+    // кандидат проходит, если (лейн ^ value[k]) & care[k] == 0 для всех трех
+    struct AddressFilter {
+        uint64_t value[3] = {};
+        uint64_t care[3] = {};
         
-        uint64_t t, bc[5];
-        int i, j, round;
+        // Биты 0..2 - лейны 1..3, в которых маска задает хотя бы один бит
+        int shape() const {
+            return (care[0] != 0 ? 1 : 0) | (care[1] != 0 ? 2 : 0) | (care[2] != 0 ? 4 : 0);
+        }
+    };
+    
+    // Фильтр по значениям и значимым битам 20 байт адреса
+    static constexpr AddressFilter addressFilter(const uint8_t value[20], const uint8_t care[20]) {
+        // Адрес начинается с байта 4 лейна 1
+        uint8_t lanesValue[24] = {}, lanesCare[24] = {};
+        for (int j = 0; j < 20; j++) {
+            lanesValue[4 + j] = value[j] & care[j];
+            lanesCare[4 + j] = care[j];
+        }
+        AddressFilter filter;
+        for (int k = 0; k < 3; k++) {
+            filter.value[k] = loadLE64(lanesValue + k * 8);
+            filter.care[k] = loadLE64(lanesCare + k * 8);
+        }
+        return filter;
+    }
+    
+private:
+    // Лейн l вектора или сам скаляр (LANES == 1)
+    template <typename V>
+    static constexpr KECCAK_INLINE uint64_t laneAt(const V& v, int l) {
+        if constexpr (std::is_same_v<V, uint64_t>) {
+            return v;
+        } else {
+            return v[l];
+        }
+    }
+    
+    template <typename V>
+    static constexpr KECCAK_INLINE void setLaneAt(V& v, int l, uint64_t value) {
+        if constexpr (std::is_same_v<V, uint64_t>) {
+            v = value;
+        } else {
+            v[l] = value;
+        }
+    }
+    
+    // Биты кандидатов, у которых diff == 0
+    template <typename V, int LANES>
+    static KECCAK_INLINE uint32_t zeroLanes(const V& diff) {
+        uint32_t bits = 0;
+        for (int l = 0; l < LANES; l++) {
+            bits |= static_cast<uint32_t>(laneAt(diff, l) == 0) << l;
+        }
+        return bits;
+    }
+    
+    // Последний раунд для адреса: байты 12..31 хеша - лейны 1..3 после раунда, а им нужна
+    // только строка 0 после Rho Pi (лейны 0, 6, 12, 18, 24 с поправкой Theta) и Chi
+    // по ней; Iota меняет лишь лейн 0. Каждый лейн - отдельное выражение, поэтому
+    // невостребованные лейны компилятор выбрасывает
+    template <typename T>
+    static constexpr KECCAK_INLINE void lastRoundRow(const T* a, T* b) {
+        T c[5], d[5];
+        columnParity(a, c);
+        for (int i = 0; i < 5; i++) {
+            d[i] = c[(i + 1) % 5];
+            rotlInPlace<T, 1>(d[i]);
+            d[i] ^= c[(i + 4) % 5];
+        }
+        b[0] = a[0] ^ d[0];
+        b[1] = a[6] ^ d[1];
+        rotlInPlace<T, RHO_OFFSETS[6]>(b[1]);
+        b[2] = a[12] ^ d[2];
+        rotlInPlace<T, RHO_OFFSETS[12]>(b[2]);
+        b[3] = a[18] ^ d[3];
+        rotlInPlace<T, RHO_OFFSETS[18]>(b[3]);
+        b[4] = a[24] ^ d[4];
+        rotlInPlace<T, RHO_OFFSETS[24]>(b[4]);
+    }
+    
+    // Лейн LANE (1..3) состояния после последнего раунда по строке lastRoundRow.
+    // Результат - через параметр: векторы не возвращаются из функций без атрибута target
+    template <int LANE, typename T>
+    static constexpr KECCAK_INLINE void lastRoundLane(const T* b, T& lane) {
+        lane = b[LANE] ^ (~b[(LANE + 1) % 5] & b[(LANE + 2) % 5]);
+    }
+    
+    // Пакетные ядра собираются из источника и приемника. Источник дает состояние
+    // кандидатов index .. index + LANES - 1 после поглощения и первых 23 раундов
+    // (head), приемник считает последний раунд и пишет результат (finish).
+    // V - uint64_t (LANES = 1) или вектор GCC из LANES лейнов
+    
+    // Независимые 64-байтные входы (публичные ключи X || Y) подряд: один блок,
+    // лейны 0-7 - данные, паддинг 0x01 в лейне 8 и 0x80 в лейне 16
+    struct Block64Source {
+        const uint8_t* inputs;
         
-        for (round = 0; round < KECCAK_ROUNDS; round++) {
-            // Theta
-            for (i = 0; i < 5; i++)
-                bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
-            
-            for (i = 0; i < 5; i++) {
-                t = bc[(i + 4) % 5] ^ ROTL64(bc[(i + 1) % 5], 1);
-                for (j = 0; j < 25; j += 5)
-                    st[j + i] ^= t;
+        template <typename V, int LANES>
+        KECCAK_INLINE void head(size_t index, V* st) const {
+            V zero = {};
+            for (int w = 0; w < 25; w++) {
+                st[w] = zero;
             }
-            
-            // Rho Pi
-            t = st[1];
-            for (i = 0; i < 24; i++) {
-                j = keccakf_piln[i];
-                bc[0] = st[j];
-                st[j] = ROTL64(t, keccakf_rotc[i]);
-                t = bc[0];
+            for (int w = 0; w < 8; w++) {
+                for (int l = 0; l < LANES; l++) {
+                    setLaneAt(st[w], l, loadLE64(inputs + (index + l) * 64 + w * 8));
+                }
             }
-            
-            // Chi
-            for (j = 0; j < 25; j += 5) {
-                for (i = 0; i < 5; i++)
-                    bc[i] = st[j + i];
-                for (i = 0; i < 5; i++)
-                    st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+            st[8] ^= 0x01;
+            st[16] ^= 0x8000000000000000ULL;
+            keccakfHead(st);
+        }
+    };
+    
+    // CREATE2: вход 0xff ++ deployer ++ salt ++ initCodeHash - ровно 85 байт, один блок.
+    // Соли пакета различаются только лейном CREATE2_COUNTER_LANE (байты 3..10 соли),
+    // поэтому состояние после поглощения (base) и четности его столбцов без этого
+    // лейна (parity) считаются один раз на пакет, а на кандидата остается записать
+    // счетчик и поправить одну четность первого раунда
+    static constexpr int CREATE2_COUNTER_LANE = 3;
+    
+    static constexpr KECCAK_INLINE void create2Absorb(const uint8_t* input, uint64_t base[25], uint64_t parity[5]) {
+        for (int w = 0; w < 25; w++) {
+            base[w] = 0;
+        }
+        for (int j = 0; j < CREATE2_INPUT_BYTES; j++) {
+            base[j / 8] ^= ((uint64_t)input[j]) << ((j % 8) * 8);
+        }
+        base[CREATE2_INPUT_BYTES / 8] ^= ((uint64_t)0x01) << ((CREATE2_INPUT_BYTES % 8) * 8);
+        base[16] ^= 0x8000000000000000ULL;
+        base[CREATE2_COUNTER_LANE] = 0;
+        columnParity(base, parity);
+    }
+    
+    // Кандидат index - соль со счетчиком counter + index
+    struct Create2Source {
+        const uint64_t* base;
+        const uint64_t* parity;
+        uint64_t counter;
+        
+        template <typename V, int LANES>
+        KECCAK_INLINE void head(size_t index, V* st) const {
+            // Скаляр в векторном выражении размножается на все лейны (broadcast)
+            V c[5], step = {};
+            for (int w = 0; w < 25; w++) {
+                st[w] = step + base[w];
+            }
+            for (int i = 0; i < 5; i++) {
+                c[i] = step + parity[i];
             }
+            for (int l = 0; l < LANES; l++) {
+                setLaneAt(step, l, static_cast<uint64_t>(l));
+            }
+            st[CREATE2_COUNTER_LANE] = step + (counter + index);
+            c[CREATE2_COUNTER_LANE % 5] ^= st[CREATE2_COUNTER_LANE];
             
-            // Iota
-            st[0] ^= keccakf_rndc[round];
+            roundFromParity(st, c, 0);
+            for (int round = 1; round < KECCAK_ROUNDS - 1; round++) {
+                columnParity(st, c);
+                roundFromParity(st, c, round);
+            }
+        }
+    };
+    
+    // CREATE: адрес контракта - байты 12..31 keccak256(rlp([sender, nonce])). RLP списка
+    // занимает 23..31 байт: 0xc0 + длина, 0x94, 20 байт адреса, nonce (0x80 для нуля, сам байт
+    // для 1..0x7f, иначе 0x80 + длина и байты big-endian). Это один блок в лейнах 0..3;
+    // адрес отправителя ложится в байты 2..21, остальное зависит только от nonce:
+    // младшие 16 бит лейна 0, старшие 16 бит лейна 2 и лейн 3 с паддингом 0x01
+    struct ContractNonceLanes {
+        uint64_t lane0 = 0, lane2 = 0, lane3 = 0;
+    };
+    
+    static constexpr ContractNonceLanes contractNonceLanes(uint64_t nonce) {
+        uint8_t block[32] = {};
+        int length = 1;
+        if (nonce == 0) {
+            block[22] = 0x80;
+        } else if (nonce < 0x80) {
+            block[22] = static_cast<uint8_t>(nonce);
+        } else {
+            int bytes = (64 - std::countl_zero(nonce) + 7) / 8;
+            block[22] = static_cast<uint8_t>(0x80 + bytes);
+            for (int j = 0; j < bytes; j++) {
+                block[23 + j] = static_cast<uint8_t>(nonce >> ((bytes - 1 - j) * 8));
+            }
+            length = 1 + bytes;
+        }
+        block[0] = static_cast<uint8_t>(0xc0 + 21 + length);
+        block[1] = 0x94;
+        block[22 + length] ^= 0x01;
+        return {loadLE64(block), loadLE64(block + 16), loadLE64(block + 24)};
+    }
+    
+    // Адреса отправителей (по 20 байт) подряд при одном nonce; читаются только их байты
+    struct ContractSource {
+        const uint8_t* senders;
+        ContractNonceLanes nonce;
+        
+        template <typename V, int LANES>
+        KECCAK_INLINE void head(size_t index, V* st) const {
+            V zero = {};
+            for (int w = 0; w < 25; w++) {
+                st[w] = zero;
+            }
+            for (int l = 0; l < LANES; l++) {
+                const uint8_t* sender = senders + (index + l) * 20;
+                setLaneAt(st[0], l, nonce.lane0 | loadLE64(sender) << 16);
+                setLaneAt(st[1], l, loadLE64(sender + 6));
+                setLaneAt(st[2], l, loadLE64(sender + 12) >> 16 | nonce.lane2);
+            }
+            st[3] = zero + nonce.lane3;
+            st[16] ^= 0x8000000000000000ULL;
+            keccakfHead(st);
+        }
+    };
+    
+    // Полные хеши (OUT_BYTES = 32) или адреса (20, только лейны 1..3 последнего раунда) подряд
+    template <int OUT_BYTES>
+    struct DigestSink {
+        uint8_t* out;
+        
+        template <typename V, int LANES>
+        KECCAK_INLINE void finish(size_t index, V* st) const {
+            if constexpr (OUT_BYTES == 32) {
+                V c[5];
+                columnParity(st, c);
+                roundFromParity(st, c, KECCAK_ROUNDS - 1);
+                for (int l = 0; l < LANES; l++) {
+                    storeDigest<32>(out + (index + l) * 32, laneAt(st[0], l), laneAt(st[1], l),
+                                    laneAt(st[2], l), laneAt(st[3], l));
+                }
+            } else {
+                V b[5];
+                lastRoundRow(st, b);
+                V w1, w2, w3;
+                lastRoundLane<1>(b, w1);
+                lastRoundLane<2>(b, w2);
+                lastRoundLane<3>(b, w3);
+                for (int l = 0; l < LANES; l++) {
+                    storeDigest<20>(out + (index + l) * 20, 0, laneAt(w1, l), laneAt(w2, l), laneAt(w3, l));
+                }
+            }
+        }
+    };
+    
+    // Адреса с фильтром маски (см. AddressFilter). SHAPE - лейны, в которых маска что-то
+    // задает: только они считаются до проверки, по порядку байтов адреса, и кандидаты
+    // отсеиваются лейн за лейном - начало адреса (лейн 1) отбрасывает почти всех до
+    // вычисления конца. Остальные лейны и сам адрес - только для прошедших
+    template <int SHAPE>
+    struct FilterSink {
+        const AddressFilter* filter;
+        uint8_t* addresses;
+        uint64_t* bits;
+        
+        // Проверка K-го лейна адреса, если он есть в SHAPE; false - не прошел никто
+        template <int K, typename V, int LANES>
+        KECCAK_INLINE bool test(const V* b, V* w, uint32_t& pass) const {
+            if constexpr ((SHAPE >> K) & 1) {
+                lastRoundLane<K + 1>(b, w[K]);
+                pass &= zeroLanes<V, LANES>((w[K] ^ filter->value[K]) & filter->care[K]);
+            }
+            return pass != 0;
+        }
+        
+        template <typename V, int LANES>
+        KECCAK_INLINE void finish(size_t index, V* st) const {
+            V b[5], w[3];
+            lastRoundRow(st, b);
+            uint32_t pass = (1u << LANES) - 1;
+            if (!test<0, V, LANES>(b, w, pass) || !test<1, V, LANES>(b, w, pass) ||
+                !test<2, V, LANES>(b, w, pass)) {
+                return;
+            }
+            if constexpr ((SHAPE & 1) == 0) {
+                lastRoundLane<1>(b, w[0]);
+            }
+            if constexpr ((SHAPE & 2) == 0) {
+                lastRoundLane<2>(b, w[1]);
+            }
+            if constexpr ((SHAPE & 4) == 0) {
+                lastRoundLane<3>(b, w[2]);
+            }
+            bits[index / 64] |= static_cast<uint64_t>(pass) << (index % 64);
+            for (; pass != 0; pass &= pass - 1) {
+                int l = std::countr_zero(pass);
+                storeDigest<20>(addresses + (index + l) * 20, 0, laneAt(w[0], l), laneAt(w[1], l),
+                                laneAt(w[2], l));
+            }
         }
+    };
+    
+#ifdef KECCAK_HAVE_SIMD_LANES
+    typedef uint64_t Lanes4 __attribute__((vector_size(32)));
+    typedef uint64_t Lanes8 __attribute__((vector_size(64)));
+    
+    template <typename Source, typename Sink>
+    __attribute__((target("avx2")))
+    static void batchx4Avx2(const Source& source, const Sink& sink, size_t index) {
+        Lanes4 st[25];
+        source.template head<Lanes4, 4>(index, st);
+        sink.template finish<Lanes4, 4>(index, st);
+    }
+    
+    // На AVX-512 компилятор сводит вращения к vprolq, а chi - к vpternlogq
+    template <typename Source, typename Sink>
+    __attribute__((target("avx512f")))
+    static void batchx8Avx512(const Source& source, const Sink& sink, size_t index) {
+        Lanes8 st[25];
+        source.template head<Lanes8, 8>(index, st);
+        sink.template finish<Lanes8, 8>(index, st);
+    }
+    
+    // Ширина SIMD-ядер по выбранному варианту (см. cpudispatch.h)
+    static bool cpuHasAvx2() {
+        return activeCpuVariant() >= CpuVariant::Avx2;
+    }
+    
+    static bool cpuHasAvx512() {
+        return activeCpuVariant() >= CpuVariant::Avx512;
+    }
+#endif
+    
+    static constexpr void keccakf(uint64_t st[25]) {
+        keccakfLanes(st);
+    }
+    
+    // Пакет из count кандидатов: по 8 в полосах AVX-512 или по 4 в AVX2, если процессор
+    // их поддерживает (см. cpudispatch.h), остаток - скалярно
+    template <typename Source, typename Sink>
+    static void runBatch(const Source& source, const Sink& sink, size_t count) {
+        size_t i = 0;
+#ifdef KECCAK_HAVE_SIMD_LANES
+        if (cpuHasAvx512()) {
+            for (; i + 8 <= count; i += 8) {
+                batchx8Avx512(source, sink, i);
+            }
+        }
+        if (cpuHasAvx2()) {
+            for (; i + 4 <= count; i += 4) {
+                batchx4Avx2(source, sink, i);
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            uint64_t st[25];
+            source.template head<uint64_t, 1>(i, st);
+            sink.template finish<uint64_t, 1>(i, st);
+        }
+    }
+    
+    // Адреса пакета: все или, с фильтром, только прошедшие его (биты - в bits).
+    // Форма фильтра выбирается один раз на пакет
+    template <typename Source, int... Shapes>
+    static void runAddressBatch(const Source& source, uint8_t* addresses, size_t count,
+                                const AddressFilter* filter, uint64_t* bits, std::integer_sequence<int, Shapes...>) {
+        if (filter == nullptr) {
+            runBatch(source, DigestSink<20>{addresses}, count);
+            return;
+        }
+        std::fill(bits, bits + (count + 63) / 64, 0);
+        int shape = filter->shape();
+        ((shape == Shapes ? (runBatch(source, FilterSink<Shapes>{filter, addresses, bits}, count), 0) : 0), ...);
+    }
+    
+    template <typename Source>
+    static void runAddressBatch(const Source& source, uint8_t* addresses, size_t count,
+                                const AddressFilter* filter, uint64_t* bits) {
+        runAddressBatch(source, addresses, count, filter, bits, std::make_integer_sequence<int, 8>());
     }
     
 public:
-    static std::vector<uint8_t> keccak256(const std::vector<uint8_t>& input) {
+    // Keccak-256 произвольной длины в буфер вызывающего (32 байта)
+    static constexpr void keccak256(const uint8_t* input, size_t inputLen, uint8_t* output) {
         uint64_t st[25] = {0};
-        uint8_t temp[144];
-        int rsiz = 200 - 2 * 32; // 136 для Keccak-256
-        int rsizw = rsiz / 8;
-        size_t inputLen = input.size();
+        const size_t rsiz = 200 - 2 * 32; // 136 для Keccak-256
+        const size_t rsizw = rsiz / 8;
         size_t offset = 0;
         
-        // Обрабатываем все полные блоки
+        // Обрабатываем все полные блоки прямо из входа
         while (offset + rsiz <= inputLen) {
-            // Копируем данные в temp
-            memcpy(temp, input.data() + offset, rsiz);
-            
-            // Преобразуем в uint64_t и XOR с состоянием
-            for (int i = 0; i < rsizw; i++) {
-                uint64_t word = 0;
-                for (int j = 0; j < 8; j++) {
-                    word |= ((uint64_t)temp[i * 8 + j]) << (j * 8);
-                }
-                st[i] ^= word;
+            for (size_t i = 0; i < rsizw; i++) {
+                st[i] ^= loadLE64(input + offset + i * 8);
             }
-            
             keccakf(st);
             offset += rsiz;
         }
         
-        // Обрабатываем последний неполный блок
-        int remaining = inputLen - offset;
-        memset(temp, 0, rsiz);
-        if (remaining > 0) {
-            memcpy(temp, input.data() + offset, remaining);
+        // Последний неполный блок: полные слова напрямую, хвост побайтово
+        size_t remaining = inputLen - offset;
+        size_t words = remaining / 8;
+        for (size_t i = 0; i < words; i++) {
+            st[i] ^= loadLE64(input + offset + i * 8);
+        }
+        for (size_t j = words * 8; j < remaining; j++) {
+            st[j / 8] ^= ((uint64_t)input[offset + j]) << ((j % 8) * 8);
         }
         
         // Keccak padding: добавляем 0x01 в конец данных, затем 0x80 в конец блока
-        temp[remaining] = 0x01;
-        temp[rsiz - 1] ^= 0x80;
-        
-        // Преобразуем в uint64_t (little-endian) и XOR с состоянием
-        for (int i = 0; i < rsizw; i++) {
-            uint64_t word = 0;
-            for (int j = 0; j < 8; j++) {
-                word |= ((uint64_t)temp[i * 8 + j]) << (j * 8);
-            }
-            st[i] ^= word;
-        }
+        st[remaining / 8] ^= ((uint64_t)0x01) << ((remaining % 8) * 8);
+        st[rsizw - 1] ^= 0x8000000000000000ULL;
         
         keccakf(st);
         
-        // Извлекаем результат (32 байта) в little-endian формате
-        std::vector<uint8_t> output(32);
         for (int i = 0; i < 4; i++) {
-            uint64_t word = st[i];
-            for (int j = 0; j < 8; j++) {
-                output[i * 8 + j] = (word >> (j * 8)) & 0xFF;
-            }
+            storeLE64(output + i * 8, st[i]);
         }
-        
+    }
+    
+    // Keccak-256 от ровно 64 байт (публичный ключ X || Y), без выделения памяти
+    static constexpr void keccak256(std::span<const uint8_t, 64> input, std::array<uint8_t, 32>& output) {
+        uint64_t st[25];
+        permute64(input.data(), st);
+        for (int i = 0; i < 4; i++) {
+            storeLE64(output.data() + i * 8, st[i]);
+        }
+    }
+    
+    // Только 20 байт адреса (байты 12..31 хеша) от 64-байтного публичного ключа
+    static constexpr void keccak256Address(const uint8_t* input, uint8_t* address) {
+        uint64_t st[25];
+        permute64(input, st);
+        storeDigest<20>(address, st[0], st[1], st[2], st[3]);
+    }
+    
+    static constexpr void keccak256Address(std::span<const uint8_t, 64> input, std::array<uint8_t, 20>& address) {
+        keccak256Address(input.data(), address.data());
+    }
+    
+    // Прежний интерфейс на векторах - обертка над версиями без выделения памяти
+    static std::vector<uint8_t> keccak256(const std::vector<uint8_t>& input) {
+        std::vector<uint8_t> output(32);
+        keccak256(input.data(), input.size(), output.data());
         return output;
     }
+    
+    // Пакетный Keccak-256 для count независимых 64-байтных входов (публичных ключей X || Y).
+    // inputs - count * 64 байт подряд, digests - count * 32 байт подряд.
+    // Используются 8 полос AVX-512 или 4 полосы AVX2, если процессор их поддерживает,
+    // остаток пакета хешируется скалярно
+    static void keccak256Batch64(const uint8_t* inputs, uint8_t* digests, size_t count) {
+        runBatch(Block64Source{inputs}, DigestSink<32>{digests}, count);
+    }
+    
+    // То же, но сразу в массив 20-байтных адресов (count * 20 байт подряд).
+    // С фильтром (см. AddressFilter) адрес пишется только для прошедших его кандидатов,
+    // а бит i массива bits ((count + 63) / 64 слов, перезаписываются) - признак прохождения
+    static void keccak256AddressBatch64(const uint8_t* inputs, uint8_t* addresses, size_t count,
+                                        const AddressFilter* filter = nullptr, uint64_t* bits = nullptr) {
+        runAddressBatch(Block64Source{inputs}, addresses, count, filter, bits);
+    }
+    
+    // Адреса контрактов CREATE для count адресов отправителей подряд (senders - count * 20 байт)
+    // при одном nonce: блок RLP собирается прямо в лейнах из адреса и констант nonce.
+    // addresses - count * 20 байт подряд. SIMD и фильтр - как у keccak256AddressBatch64
+    static void contractAddressBatch(const uint8_t* senders, uint64_t nonce, uint8_t* addresses, size_t count,
+                                     const AddressFilter* filter = nullptr, uint64_t* bits = nullptr) {
+        runAddressBatch(ContractSource{senders, contractNonceLanes(nonce)}, addresses, count, filter, bits);
+    }
+    
+    static constexpr int CREATE2_INPUT_BYTES = 85;
+    
+    // Адреса CREATE2 (байты 12..31 keccak256(input)) для count солей подряд: input - 85 байт
+    // 0xff ++ deployer ++ salt ++ initCodeHash, байты 3..10 соли (байты 24..31 входа)
+    // заменяются счетчиком counter + i в little-endian. addresses - count * 20 байт подряд.
+    // SIMD и фильтр - как у keccak256AddressBatch64
+    static void create2AddressBatch(const uint8_t* input, uint64_t counter, uint8_t* addresses, size_t count,
+                                    const AddressFilter* filter = nullptr, uint64_t* bits = nullptr) {
+        uint64_t base[25], parity[5];
+        create2Absorb(input, base, parity);
+        runAddressBatch(Create2Source{base, parity, counter}, addresses, count, filter, bits);
+    }
 };
 
 #endif // KECCAK_H
\ No newline at end of file
@@ -10,6 +10,9 @@
 #include <algorithm>
 #include <cctype>
 #include <mutex>
+#include <array>
+#include <span>
+#include <filesystem>
 
 #include <openssl/ec.h>
 #include <openssl/ecdsa.h>
@@ -18,51 +21,48 @@
 #include <openssl/evp.h>
 
 #include "keccak.h"
+#include "secp256k1.h"
+#include "mask.h"
+#include "address.h"
+#include "search.h"
+#include "server.h"
+#include "metrics.h"
+#include "resources.h"
+#include "cluster.h"
+#include "selfcheck.h"
 
-// Структура для хранения результата
-struct Result {
-    std::vector<uint8_t> privateKey;
-    std::vector<uint8_t> addressBytes;
-    bool found = false;
-};
 
-// Глобальные переменные для масок (оптимизированные)
-struct Mask {
-    uint8_t prefix[2];  // Байты для префикса
-    bool prefixWildcard[2];
-    bool prefixCaseSensitive[2];  // true если нужно учитывать регистр
-    uint8_t suffix[6];  // Байты для суффикса (4 или 6 символов)
-    bool suffixWildcard[6];
-    bool suffixCaseSensitive[6];  // true если нужно учитывать регистр
-    int suffixLength = 4;  // Длина суффикса (4 или 6)
-    bool checkCase = false;  // true если нужно проверять регистр
-} globalMask;
-
-// Атомарные переменные для синхронизации
-std::atomic<long long> totalAttempts(0);
-std::atomic<bool> found(false);
-Result foundResult;
-std::mutex resultMutex;
-
-// Быстрая генерация случайного приватного ключа (оптимизированная)
-void generatePrivateKeyFast(std::vector<uint8_t>& privateKey, std::mt19937& gen) {
-    // Генерируем по 4 байта за раз для большей скорости
-    uint32_t* ptr = reinterpret_cast<uint32_t*>(privateKey.data());
-    for (int i = 0; i < 8; i++) {
-        ptr[i] = gen();
-    }
-}
-
-// Оптимизированное получение публичного ключа (с переиспользованием контекста)
-std::vector<uint8_t> getPublicKeyFast(const std::vector<uint8_t>& privateKey, 
-                                      EC_GROUP* group, BN_CTX* ctx) {
-    EC_POINT* pub_point = EC_POINT_new(group);
+// Функция для проверки правильности вычисления адреса
+// Намеренно использует OpenSSL: независимая проверка собственной арифметики secp256k1.
+// С публичным ключом клиента basePublicKey (0x04 + X + Y) проверяется адрес точки Q + k*G
+std::string verifyAddressFromPrivateKey(const std::vector<uint8_t>& privateKey,
+                                        const std::vector<uint8_t>& basePublicKey = {}) {
+    EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+    BN_CTX* ctx = BN_CTX_new();
     BIGNUM* priv = BN_bin2bn(privateKey.data(), 32, nullptr);
+    BIGNUM* one = BN_new();
+    BN_one(one);
     
-    if (EC_POINT_mul(group, pub_point, priv, nullptr, nullptr, ctx) != 1) {
+    EC_POINT* pub_point = EC_POINT_new(group);
+    EC_POINT* base_point = nullptr;
+    if (!basePublicKey.empty()) {
+        base_point = EC_POINT_new(group);
+        if (EC_POINT_oct2point(group, base_point, basePublicKey.data(), basePublicKey.size(), ctx) != 1) {
+            EC_POINT_free(base_point);
+            base_point = nullptr;
+        }
+    }
+    
+    // k*G или k*G + 1*Q
+    bool ok = basePublicKey.empty() || base_point != nullptr;
+    if (!ok || EC_POINT_mul(group, pub_point, priv, base_point, base_point ? one : nullptr, ctx) != 1) {
         EC_POINT_free(pub_point);
+        EC_POINT_free(base_point);
+        EC_GROUP_free(group);
         BN_free(priv);
-        return {};
+        BN_free(one);
+        BN_CTX_free(ctx);
+        return "";
     }
     
     size_t pubKeyLen = EC_POINT_point2oct(group, pub_point, 
@@ -72,422 +72,921 @@ std::vector<uint8_t> getPublicKeyFast(const std::vector<uint8_t>& privateKey,
     EC_POINT_point2oct(group, pub_point, POINT_CONVERSION_UNCOMPRESSED,
                        publicKey.data(), pubKeyLen, ctx);
     
+    // Вычисляем адрес
+    AddressBytes addressBytes = getAddressBytes(publicKey);
+    std::string address = addressBytesToHex(addressBytes);
+    
     EC_POINT_free(pub_point);
+    EC_POINT_free(base_point);
+    EC_GROUP_free(group);
     BN_free(priv);
+    BN_free(one);
+    BN_CTX_free(ctx);
     
-    return publicKey;
-}
-
-// Быстрое вычисление адреса без создания строки
-std::vector<uint8_t> getAddressBytes(const std::vector<uint8_t>& publicKey) {
-    // Публичный ключ в формате 0x04 + X + Y (65 байт)
-    // Берем только X и Y (пропускаем первый байт 0x04)
-    std::vector<uint8_t> pubKeyBytes(publicKey.begin() + 1, publicKey.end());
-    
-    // Вычисляем Keccak-256 хеш
-    std::vector<uint8_t> hash = Keccak::keccak256(pubKeyBytes);
-    
-    // Берем последние 20 байт (адрес)
-    return std::vector<uint8_t>(hash.end() - 20, hash.end());
+    return address;
 }
 
-// Lookup таблица для быстрого преобразования байта в hex символ
-static const char hexChars[] = "0123456789abcdef";
-
-// Forward declarations
-std::string addressBytesToHex(const std::vector<uint8_t>& addressBytes);
-std::string getAddressWithChecksum(const std::vector<uint8_t>& addressBytes);
-
-// Конвертация байтов адреса в hex строку (без checksum, нижний регистр)
-std::string addressBytesToHex(const std::vector<uint8_t>& addressBytes) {
-    std::stringstream ss;
-    ss << "0x";
-    for (uint8_t byte : addressBytes) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
-    }
-    return ss.str();
+// Вывод совпадения в текстовом формате по мере нахождения (наборы шаблонов и --score)
+void printHitText(const SearchJob& job, const SearchHit& hit) {
+    std::vector<uint8_t> privateKey(32);
+    hit.key.toBytes(privateKey.data());
+    std::string computedAddress = addressBytesToHex(hit.addressBytes);
+    std::string deployer;
+    bool verified = verifyHitAddress(job, hit, verifyAddressFromPrivateKey, &deployer) == computedAddress;
+    std::string addressToShow = hit.checksum ? getAddressWithChecksum(hit.addressBytes) : computedAddress;
+    
+    if (job.kind == SearchKind::Patterns) {
+        std::cout << "\n✓ [" << job.patterns.texts[hit.patternIndex] << "] Адрес: " << addressToShow;
+    } else {
+        std::cout << "\n★ Счет " << hit.score << ": Адрес: " << addressToShow;
+    }
+    if (job.contractNonces > 0) {
+        std::cout << " | Деплоер: " << deployer << ", nonce " << hit.nonce;
+    }
+    std::cout << (job.splitKey() ? " | Смещение: " : " | Приватный ключ: ") << privateKeyToHex(privateKey)
+              << (verified ? " | ✓ проверен" : " | ⚠ ОШИБКА проверки") << std::endl;
 }
 
-// Получение адреса с checksum для проверки маски (EIP-55)
-std::string getAddressWithChecksum(const std::vector<uint8_t>& addressBytes) {
-    // EIP-55: хешируем адрес как строку в нижнем регистре (без 0x)
-    std::string addressLower;
-    for (uint8_t byte : addressBytes) {
-        addressLower += hexChars[(byte >> 4) & 0x0F];
-        addressLower += hexChars[byte & 0x0F];
-    }
-    
-    // Вычисляем Keccak-256 хеш строки адреса
-    std::vector<uint8_t> addressStrBytes(addressLower.begin(), addressLower.end());
-    std::vector<uint8_t> hash = Keccak::keccak256(addressStrBytes);
-    
-    // Создаем адрес с checksum
-    // Для каждого символа адреса берем соответствующий nibble из хеша
-    // Если nibble >= 8, символ должен быть заглавным
-    std::string result = "0x";
-    for (size_t i = 0; i < addressLower.length(); i++) {
-        char c = addressLower[i];
-        
-        // Получаем соответствующий nibble из хеша
-        size_t hashByteIndex = i / 2;
-        bool isHighNibble = (i % 2 == 0);
-        uint8_t hashNibble = isHighNibble ? 
-            ((hash[hashByteIndex] >> 4) & 0x0F) : 
-            (hash[hashByteIndex] & 0x0F);
-        
-        // Применяем checksum (EIP-55): если nibble хеша >= 8, символ должен быть заглавным
-        if (hashNibble >= 8 && c >= 'a' && c <= 'f') {
-            c = c - 'a' + 'A';
-        }
-        
-        result += c;
+// Вывод найденной соли CREATE2: адрес перепроверяется общим Keccak-256 по полному входу
+void printCreate2Result(const SearchJob& job, const SearchHit& hit) {
+    std::string computedAddress = addressBytesToHex(hit.addressBytes);
+    std::cout << "\n\n✓ Адрес контракта найден!" << std::endl;
+    std::cout << "Адрес: " << (hit.checksum ? getAddressWithChecksum(hit.addressBytes) : computedAddress) << std::endl;
+    if (hit.checksum) {
+        std::cout << "Адрес (lowercase): " << computedAddress << std::endl;
+    }
+    std::cout << "Соль: " << saltToHex(hit.salt) << std::endl;
+    AddressBytes expected = create2Address(job.create2, hit.salt);
+    if (expected == hit.addressBytes) {
+        std::cout << "✓ Проверка: адрес вычислен правильно" << std::endl;
+    } else {
+        std::cout << "⚠ ОШИБКА: адрес не совпадает с проверкой!" << std::endl;
+        std::cout << "  Вычисленный: " << computedAddress << std::endl;
+        std::cout << "  Проверенный: " << addressBytesToHex(expected) << std::endl;
     }
-    
-    return result;
 }
 
-// Быстрая проверка маски на байтах (с учетом регистра)
-bool matchesMaskFast(const std::vector<uint8_t>& addressBytes) {
-    // Если нужно проверять регистр, получаем адрес с checksum
-    std::string addressStr;
-    if (globalMask.checkCase) {
-        addressStr = getAddressWithChecksum(addressBytes);
-    } else {
-        // Просто нижний регистр
-        addressStr = addressBytesToHex(addressBytes);
+// Вывод найденного по маске адреса в текстовом формате (маска Ethereum или TRON)
+void printMaskResult(const SearchJob& job, const SearchHit& hit) {
+    if (job.kind == SearchKind::Create2) {
+        printCreate2Result(job, hit);
+        return;
     }
+    std::vector<uint8_t> privateKey(32);
+    hit.key.toBytes(privateKey.data());
     
-    std::string addr = addressStr.substr(2); // Убираем 0x
+    // Проверяем правильность вычисления адреса (в режиме адресов контрактов - через адрес ключа)
+    std::string deployer;
+    std::string verifiedAddress = verifyHitAddress(job, hit, verifyAddressFromPrivateKey, &deployer);
+    std::string computedAddress = addressBytesToHex(hit.addressBytes);
     
-    // Проверяем префикс (первые 2 символа)
-    if (!globalMask.prefixWildcard[0]) {
-        char addrChar = addr[0];
-        char maskChar = globalMask.prefix[0];
-        
-        if (globalMask.prefixCaseSensitive[0]) {
-            // Учитываем регистр
-            if (addrChar != maskChar) return false;
-        } else {
-            // Не учитываем регистр
-            if (std::tolower(addrChar) != std::tolower(maskChar)) return false;
-        }
-    }
+    std::cout << "\n\n✓ Адрес найден!" << std::endl;
     
-    if (!globalMask.prefixWildcard[1]) {
-        char addrChar = addr[1];
-        char maskChar = globalMask.prefix[1];
-        
-        if (globalMask.prefixCaseSensitive[1]) {
-            if (addrChar != maskChar) return false;
-        } else {
-            if (std::tolower(addrChar) != std::tolower(maskChar)) return false;
+    // Выводим адрес с checksum, если нужно
+    if (job.kind == SearchKind::Tron) {
+        std::cout << "Адрес TRON: " << tronAddress(hit.addressBytes.data()) << std::endl;
+        std::cout << "Адрес (hex): " << computedAddress << std::endl;
+    } else {
+        std::string addressToShow = hit.checksum ? 
+            getAddressWithChecksum(hit.addressBytes) : 
+            computedAddress;
+        std::cout << (job.contractNonces > 0 ? "Адрес контракта: " : "Адрес: ") << addressToShow << std::endl;
+        if (hit.checksum) {
+            std::cout << "Адрес (lowercase): " << computedAddress << std::endl;
         }
     }
-    
-    // Проверяем суффикс (последние 4 или 6 символов)
-    size_t suffixStart = addr.length() - globalMask.suffixLength;
-    for (int i = 0; i < globalMask.suffixLength; i++) {
-        if (!globalMask.suffixWildcard[i]) {
-            char addrChar = addr[suffixStart + i];
-            char maskChar = globalMask.suffix[i];
-            
-            if (globalMask.suffixCaseSensitive[i]) {
-                if (addrChar != maskChar) return false;
-            } else {
-                if (std::tolower(addrChar) != std::tolower(maskChar)) return false;
-            }
-        }
+    if (job.contractNonces > 0) {
+        std::cout << "Адрес деплоера: " << deployer << " (контракт - его CREATE с nonce " << hit.nonce << ")"
+                  << std::endl;
+    }
+    if (job.splitKey()) {
+        std::cout << "Смещение k: " << privateKeyToHex(privateKey) << std::endl;
+    } else {
+        std::cout << "Приватный ключ: " << privateKeyToHex(privateKey) << std::endl;
     }
     
-    return true;
+    // Проверка правильности
+    if (verifiedAddress == computedAddress) {
+        std::cout << "✓ Проверка: адрес вычислен правильно" << std::endl;
+    } else {
+        std::cout << "⚠ ОШИБКА: адрес не совпадает с проверкой!" << std::endl;
+        std::cout << "  Вычисленный: " << computedAddress << std::endl;
+        std::cout << "  Проверенный: " << verifiedAddress << std::endl;
+    }
 }
 
-
-// Конвертация приватного ключа в hex строку (всегда полный формат)
-std::string privateKeyToHex(const std::vector<uint8_t>& privateKey) {
-    std::stringstream ss;
-    ss << "0x";
-    ss << std::hex << std::setfill('0');
-    for (uint8_t byte : privateKey) {
-        ss << std::setw(2) << static_cast<int>(byte);
-    }
-    return ss.str();
+void printUsage() {
+    std::cout << "Использование: CryptoSpider [параметры]\n"
+              << "  --prefix <маска>       начало адреса после 0x\n"
+              << "  --suffix <маска>       конец адреса\n"
+              << "  --count <N>            сколько адресов найти по маске (по умолчанию 1)\n"
+              << "  --tron                 маска адреса TRON в base58: --prefix с T, --suffix до 7 символов\n"
+              << "  --create2 <деплоер>    маска адреса контракта CREATE2: перебор соли для адреса\n"
+              << "                         деплоера (фабрики), требует --init-code-hash\n"
+              << "  --init-code-hash <хеш> keccak256 от init-кода контракта для --create2\n"
+              << "  --contract             маска для адреса первого контракта ключа (CREATE, nonce 0),\n"
+              << "                         а не для адреса самого ключа\n"
+              << "  --max-nonce <N>        то же для контрактов с nonce 0..N (N < " << MAX_CONTRACT_NONCES << ")\n"
+              << "  --patterns <файл>      набор шаблонов \"префикс суффикс\", по одному на строку\n"
+              << "  --limit <N>            остановиться после N совпадений набора шаблонов\n"
+              << "  --score <режим>        поиск лучшего адреса: zeros, zero-bytes, repeat\n"
+              << "  --target <N>           целевой счет для --score\n"
+              << "  --split-key <ключ>     разделенный ключ: публичный ключ клиента Q (hex, 33 или 65 байт);\n"
+              << "                         ищется смещение k, итоговый ключ = ключ клиента + k (mod n)\n"
+              << "  --threads <N>          количество рабочих потоков\n"
+              << "  --timeout <сек>        ограничение времени поиска\n"
+              << "  --background           фоновый режим: низкий приоритет (SCHED_IDLE) и подстройка\n"
+              << "                         числа активных потоков по скорости и троттлингу\n"
+              << "  --cpu-share <доля>     доля доступных CPU для потоков, например 0.5\n"
+              << "  --batch-size <N>       точек в пакете обхода, степень двойки 256..16384\n"
+              << "                         (по умолчанию - по размеру кэша L2)\n"
+              << "  --cpu-variant <вариант>  ядра Keccak и арифметики поля: generic, avx2 или avx512\n"
+              << "                         (по умолчанию - лучший, который поддерживает процессор)\n"
+              << "  --placement <режим>    закрепление потоков: none (по умолчанию), cores - по потоку\n"
+              << "                         на физическое ядро, smt - на все логические CPU\n"
+              << "  --format <text|json>   формат вывода результатов\n"
+              << "  --gtable <файл>        таблица кратных G (создается, если файла нет)\n"
+              << "  --gtable-bits <N>      ширина окна таблицы, 4..8 (по умолчанию 6, ~170 КБ)\n"
+              << "  --checkpoint <файл>    детерминированное разбиение ключей с контрольной точкой\n"
+              << "  --resume               продолжить поиск с контрольной точки\n"
+              << "  --checkpoint-interval <сек>  период записи контрольной точки (по умолчанию 30)\n"
+              << "  --metrics <адрес>      HTTP-метрики Prometheus (/metrics) и статус JSON (/status):\n"
+              << "                         порт на 127.0.0.1, хост:порт или путь Unix-сокета\n"
+              << "  --status-file <файл>   периодическая запись статуса JSON в файл\n"
+              << "  --status-interval <сек>  период записи статуса (по умолчанию 10)\n"
+              << "  --profile              профиль стадий горячего цикла в stderr: такты на адрес,\n"
+              << "                         p50/p99 времени пакета, простой потоков\n"
+              << "  --profile-interval <сек>  период сводки профиля (по умолчанию 10, 0 - только итог)\n"
+              << "  --server               сервер задач: запросы JSON по строкам из stdin\n"
+              << "  --socket <путь>        сервер задач на локальном Unix-сокете\n"
+              << "  --coordinator <адрес>  координатор кластера: раздает блоки ключей рабочим процессам;\n"
+              << "                         порт на 127.0.0.1, хост:порт или путь Unix-сокета\n"
+              << "  --worker <адрес>       рабочий процесс кластера: задачу и блоки выдает координатор\n"
+              << "Без --prefix/--suffix/--patterns/--score маска запрашивается интерактивно." << std::endl;
 }
 
-// Функция для проверки правильности вычисления адреса
-std::string verifyAddressFromPrivateKey(const std::vector<uint8_t>& privateKey) {
-    EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
-    BN_CTX* ctx = BN_CTX_new();
-    BIGNUM* priv = BN_bin2bn(privateKey.data(), 32, nullptr);
+int main(int argc, char* argv[]) {
+    std::string prefixMask;
+    std::string suffixMask;
+    bool hasMaskArgs = false;
+    std::string patternsFile;
+    std::string scoreModeName;
+    std::string format = "text";
+    std::string socketPath;
+    bool serverMode = false;
+    bool hasResultLimit = false;
+    unsigned int numThreads = 0;
+    std::string placementName = "none";
+    bool background = false;
+    double cpuShare = 1.0;
+    std::string tablePath;
+    int tableBits = secp256k1::GeneratorTable::DEFAULT_WINDOW_BITS;
+    std::string checkpointPath;
+    bool resume = false;
+    double checkpointInterval = 30;
+    std::string metricsAddress;
+    std::string statusFile;
+    double statusInterval = 10;
+    bool profile = false;
+    double profileInterval = 10;
+    std::string splitKeyHex;
+    size_t batchSize = 0;
+    std::string cpuVariantArg;
+    bool tron = false;
+    std::string create2Deployer;
+    bool contract = false;
+    long long maxNonce = -1;
+    std::string initCodeHash;
+    std::string coordinatorAddress;
+    std::string workerAddress;
+    
+    auto job = std::make_shared<SearchJob>();
+    
+    // Разбор аргументов командной строки
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--help" || arg == "-h") {
+                printUsage();
+                return 0;
+            } else if (arg == "--prefix" && hasValue) {
+                prefixMask = argv[++i];
+                hasMaskArgs = true;
+            } else if (arg == "--suffix" && hasValue) {
+                suffixMask = argv[++i];
+                hasMaskArgs = true;
+            } else if ((arg == "--count" || arg == "--limit") && hasValue) {
+                job->resultLimit = std::stoull(argv[++i]);
+                hasResultLimit = true;
+            } else if (arg == "--tron") {
+                tron = true;
+            } else if (arg == "--contract") {
+                contract = true;
+            } else if (arg == "--max-nonce" && hasValue) {
+                maxNonce = std::stoll(argv[++i]);
+                contract = true;
+            } else if (arg == "--create2" && hasValue) {
+                create2Deployer = argv[++i];
+            } else if (arg == "--init-code-hash" && hasValue) {
+                initCodeHash = argv[++i];
+            } else if (arg == "--patterns" && hasValue) {
+                patternsFile = argv[++i];
+            } else if (arg == "--score" && hasValue) {
+                scoreModeName = argv[++i];
+            } else if (arg == "--target" && hasValue) {
+                job->scoreTarget = std::stoi(argv[++i]);
+            } else if (arg == "--split-key" && hasValue) {
+                splitKeyHex = argv[++i];
+            } else if (arg == "--threads" && hasValue) {
+                numThreads = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else if (arg == "--background") {
+                background = true;
+            } else if (arg == "--cpu-share" && hasValue) {
+                cpuShare = std::stod(argv[++i]);
+            } else if (arg == "--batch-size" && hasValue) {
+                batchSize = std::stoull(argv[++i]);
+            } else if (arg == "--cpu-variant" && hasValue) {
+                cpuVariantArg = argv[++i];
+            } else if (arg == "--placement" && hasValue) {
+                placementName = argv[++i];
+            } else if (arg == "--timeout" && hasValue) {
+                job->timeoutSeconds = std::stod(argv[++i]);
+            } else if (arg == "--format" && hasValue) {
+                format = argv[++i];
+            } else if (arg == "--gtable" && hasValue) {
+                tablePath = argv[++i];
+            } else if (arg == "--gtable-bits" && hasValue) {
+                tableBits = std::stoi(argv[++i]);
+            } else if (arg == "--checkpoint" && hasValue) {
+                checkpointPath = argv[++i];
+            } else if (arg == "--resume") {
+                resume = true;
+            } else if (arg == "--checkpoint-interval" && hasValue) {
+                checkpointInterval = std::stod(argv[++i]);
+            } else if (arg == "--metrics" && hasValue) {
+                metricsAddress = argv[++i];
+            } else if (arg == "--status-file" && hasValue) {
+                statusFile = argv[++i];
+            } else if (arg == "--status-interval" && hasValue) {
+                statusInterval = std::stod(argv[++i]);
+            } else if (arg == "--profile") {
+                profile = true;
+            } else if (arg == "--profile-interval" && hasValue) {
+                profileInterval = std::stod(argv[++i]);
+                profile = true;
+            } else if (arg == "--server") {
+                serverMode = true;
+            } else if (arg == "--socket" && hasValue) {
+                socketPath = argv[++i];
+                serverMode = true;
+            } else if (arg == "--coordinator" && hasValue) {
+                coordinatorAddress = argv[++i];
+            } else if (arg == "--worker" && hasValue) {
+                workerAddress = argv[++i];
+            } else {
+                std::cerr << "Ошибка: неизвестный аргумент: " << arg << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Ошибка: некорректное числовое значение аргумента" << std::endl;
+        return 1;
+    }
     
-    EC_POINT* pub_point = EC_POINT_new(group);
+    if (format != "text" && format != "json") {
+        std::cerr << "Ошибка: неизвестный формат вывода: " << format << std::endl;
+        return 1;
+    }
+    bool jsonOutput = format == "json";
     
-    if (EC_POINT_mul(group, pub_point, priv, nullptr, nullptr, ctx) != 1) {
-        EC_POINT_free(pub_point);
-        EC_GROUP_free(group);
-        BN_free(priv);
-        BN_CTX_free(ctx);
-        return "";
+    // Размещение потоков по топологии процессора
+    Placement placementMode;
+    if (!parsePlacement(placementName, placementMode)) {
+        std::cerr << "Ошибка: неизвестный режим размещения: " << placementName << std::endl;
+        return 1;
+    }
+    CpuTopology topology;
+    std::vector<ThreadPlacement> placementPlan;
+    if (placementMode != Placement::None) {
+        topology = readCpuTopology();
+        placementPlan = planPlacement(topology, placementMode);
     }
     
-    size_t pubKeyLen = EC_POINT_point2oct(group, pub_point, 
-                                          POINT_CONVERSION_UNCOMPRESSED, 
-                                          nullptr, 0, ctx);
-    std::vector<uint8_t> publicKey(pubKeyLen);
-    EC_POINT_point2oct(group, pub_point, POINT_CONVERSION_UNCOMPRESSED,
-                       publicKey.data(), pubKeyLen, ctx);
+    if (!(cpuShare > 0 && cpuShare <= 1)) {
+        std::cerr << "Ошибка: --cpu-share должен быть от 0 до 1" << std::endl;
+        return 1;
+    }
     
-    // Вычисляем адрес
-    std::vector<uint8_t> addressBytes = getAddressBytes(publicKey);
-    std::string address = addressBytesToHex(addressBytes);
+    // Определяем количество потоков: по умолчанию - по доступным процессу CPU
+    // (квота cgroup и маска допустимых CPU) с учетом --cpu-share и плана размещения
+    if (numThreads == 0) {
+        numThreads = defaultWorkerCount(cpuShare);
+        if (!placementPlan.empty()) {
+            numThreads = std::min(numThreads, static_cast<unsigned int>(placementPlan.size()));
+        }
+    }
     
-    EC_POINT_free(pub_point);
-    EC_GROUP_free(group);
-    BN_free(priv);
-    BN_CTX_free(ctx);
+    // Вариант горячих ядер: выбирается до первых вычислений (таблица G, потоки пула)
+    if (!cpuVariantArg.empty()) {
+        CpuVariant variant;
+        if (!parseCpuVariant(cpuVariantArg, variant)) {
+            std::cerr << "Ошибка: неизвестный вариант ядер: " << cpuVariantArg << " (generic, avx2, avx512)" << std::endl;
+            return 1;
+        }
+        if (!forceCpuVariant(variant)) {
+            std::cerr << "Ошибка: процессор не поддерживает вариант ядер " << cpuVariantArg << " ("
+                      << cpuVariantFeatures(variant) << ")" << std::endl;
+            return 1;
+        }
+    }
     
-    return address;
-}
-
-// Функция рабочего потока
-void workerThread(int threadId, int numThreads) {
-    // Создаем свой генератор случайных чисел для каждого потока
-    std::random_device rd;
-    std::mt19937 gen(rd() + threadId);
+    // Пакетные ядра Keccak выбранного варианта против скалярного keccak256
+    std::string kernelError;
+    if (!checkKeccakKernels(kernelError)) {
+        std::cerr << "Ошибка: самопроверка ядер Keccak (" << cpuVariantName(activeCpuVariant()) << "): "
+                  << kernelError << std::endl;
+        return 1;
+    }
     
-    // Создаем криптографические контексты для переиспользования
-    EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
-    BN_CTX* ctx = BN_CTX_new();
+    // Размер пакета обхода: данные пакета должны помещаться в L2
+    if (batchSize == 0) {
+        batchSize = chooseWalkBatchSize(cacheSizeBytes(2));
+    } else if (!validWalkBatchSize(batchSize)) {
+        std::cerr << "Ошибка: --batch-size должен быть степенью двойки от " << MIN_WALK_BATCH_SIZE
+                  << " до " << MAX_WALK_BATCH_SIZE << std::endl;
+        return 1;
+    }
     
-    std::vector<uint8_t> privateKey(32);
-    long long localAttempts = 0;
-    const long long reportInterval = 50000; // Реже обновляем счетчик
+    // Фоновый режим: приоритет наследуют потоки пула, создаваемые ниже
+    if (background && !enterBackgroundPriority()) {
+        std::cerr << "Предупреждение: не удалось понизить приоритет процесса" << std::endl;
+    }
+    std::vector<ThreadPlacement> placement;
+    for (unsigned int i = 0; i < numThreads && !placementPlan.empty(); i++) {
+        placement.push_back(placementPlan[i % placementPlan.size()]);
+    }
     
-    while (!found.load()) {
-        localAttempts++;
-        
-        // Обновляем глобальный счетчик периодически
-        if (localAttempts % reportInterval == 0) {
-            totalAttempts.fetch_add(reportInterval);
-            localAttempts = 0;
-        }
-        
-        // Генерируем приватный ключ
-        generatePrivateKeyFast(privateKey, gen);
-        
-        // Получаем публичный ключ
-        std::vector<uint8_t> publicKey = getPublicKeyFast(privateKey, group, ctx);
-        
-        if (publicKey.empty()) {
-            continue;
+    // Таблица кратных G из файла: отображается в память, при отсутствии - считается и сохраняется
+    if (!tablePath.empty()) {
+        if (tableBits < secp256k1::GeneratorTable::MIN_WINDOW_BITS ||
+            tableBits > secp256k1::GeneratorTable::MAX_WINDOW_BITS) {
+            std::cerr << "Ошибка: --gtable-bits должен быть от " << secp256k1::GeneratorTable::MIN_WINDOW_BITS
+                      << " до " << secp256k1::GeneratorTable::MAX_WINDOW_BITS << std::endl;
+            return 1;
         }
-        
-        // Вычисляем адрес
-        std::vector<uint8_t> addressBytes = getAddressBytes(publicKey);
-        
-        // Проверяем маску
-        if (matchesMaskFast(addressBytes)) {
-            // Нашли подходящий адрес!
-            std::lock_guard<std::mutex> lock(resultMutex);
-            if (!found.load()) {
-                foundResult.privateKey = privateKey;
-                foundResult.addressBytes = addressBytes;
-                foundResult.found = true;
-                found.store(true);
-            }
-            break;
+        std::string warning;
+        secp256k1::installGeneratorTable(secp256k1::loadOrBuildGeneratorTable(tablePath, tableBits, warning));
+        if (!warning.empty()) {
+            std::cerr << "Таблица G: " << warning << std::endl;
         }
     }
     
-    // Обновляем финальный счетчик
-    totalAttempts.fetch_add(localAttempts);
+    // Метрики: сглаживание скорости, файл статуса и HTTP-эндпоинт
+    auto startMetrics = [&](MetricsReporter& metrics) {
+        metrics.start(statusFile, statusInterval);
+        if (metricsAddress.empty()) {
+            return true;
+        }
+#ifndef _WIN32
+        std::string metricsError;
+        if (!metrics.serveHttp(metricsAddress, metricsError)) {
+            std::cerr << "Ошибка: " << metricsError << std::endl;
+            return false;
+        }
+        return true;
+#else
+        std::cerr << "Ошибка: HTTP-эндпоинт метрик не поддерживается на этой платформе, "
+                  << "используйте --status-file" << std::endl;
+        return false;
+#endif
+    };
     
-    // Освобождаем ресурсы
-    EC_GROUP_free(group);
-    BN_CTX_free(ctx);
-}
-
-int main() {
-    std::cout << "=== Генератор Vanity Адресов BEP20 (Оптимизированная версия) ===" << std::endl;
-    std::cout << "Введите первые 2 символа после 0x (используйте ? для любого символа): ";
-    std::string prefixMask;
-    std::cin >> prefixMask;
+    // Профиль стадий (--profile): периодическая сводка в stderr, итог - при завершении
+    auto startProfile = [&](SearchPool& pool) {
+        std::unique_ptr<ProfileReporter> profiler;
+        if (profile) {
+            profiler = std::make_unique<ProfileReporter>(pool, std::cerr);
+            profiler->start(profileInterval);
+        }
+        return profiler;
+    };
     
-    std::cout << "Введите последние 4 или 6 символов (используйте ? для любого символа): ";
-    std::string suffixMask;
-    std::cin >> suffixMask;
+    // Сервер задач: пул потоков живет все время работы процесса
+    auto describePlacement = [&](std::ostream& out) {
+        if (!placement.empty()) {
+            out << "Размещение: " << placementName << ", физических ядер: " << topology.physicalCores()
+                << ", логических CPU: " << topology.cpus.size() << ", узлов NUMA: " << topology.nodeCount << std::endl;
+        }
+    };
     
-    // Валидация масок
-    if (prefixMask.length() != 2) {
-        std::cerr << "Ошибка: префикс должен содержать ровно 2 символа" << std::endl;
-        return 1;
-    }
+    auto describeKernels = [&](std::ostream& out) {
+        CpuVariant variant = activeCpuVariant();
+        out << "Ядра: " << cpuVariantName(variant) << " (" << cpuVariantFeatures(variant) << ")"
+            << (cpuVariantArg.empty() ? "" : ", задано --cpu-variant") << std::endl;
+    };
     
-    if (suffixMask.length() != 4 && suffixMask.length() != 6) {
-        std::cerr << "Ошибка: суффикс должен содержать 4 или 6 символов" << std::endl;
+    if (serverMode) {
+        describeKernels(std::cerr);
+        describePlacement(std::cerr);
+        SearchPool pool(numThreads, placement, topology.nodeCount, batchSize);
+        std::unique_ptr<AdaptiveWorkers> adaptive;
+        if (background) {
+            adaptive = std::make_unique<AdaptiveWorkers>(pool, numThreads);
+        }
+        MetricsReporter metrics(pool);
+        if (!startMetrics(metrics)) {
+            return 1;
+        }
+        auto profiler = startProfile(pool);
+        JobServer server(pool, verifyAddressFromPrivateKey);
+        if (socketPath.empty()) {
+            return server.serveStream(std::cin, std::cout);
+        }
+#ifndef _WIN32
+        std::cerr << "Сервер задач: " << socketPath << ", потоков: " << numThreads << std::endl;
+        return server.serveSocket(socketPath);
+#else
+        std::cerr << "Ошибка: Unix-сокеты не поддерживаются на этой платформе, используйте --server" << std::endl;
         return 1;
+#endif
     }
     
-    // Проверяем, что символы валидны (0-9, a-f, A-F, ?)
-    auto isValidHexChar = [](char c) {
-        return (c >= '0' && c <= '9') || 
-               (c >= 'a' && c <= 'f') || 
-               (c >= 'A' && c <= 'F') || 
-               c == '?';
-    };
-    
-    for (char c : prefixMask) {
-        if (!isValidHexChar(c)) {
-            std::cerr << "Ошибка: недопустимый символ в префиксе: " << c << std::endl;
+    if (!coordinatorAddress.empty()) {
+#ifdef _WIN32
+        std::cerr << "Ошибка: кластер не поддерживается на этой платформе" << std::endl;
+        return 1;
+#endif
+        if (!metricsAddress.empty() || !statusFile.empty() || profile) {
+            std::cerr << "Ошибка: метрики считаются в рабочих процессах, у координатора их нет" << std::endl;
             return 1;
         }
     }
     
-    for (char c : suffixMask) {
-        if (!isValidHexChar(c)) {
-            std::cerr << "Ошибка: недопустимый символ в суффиксе: " << c << std::endl;
+    // Рабочий процесс кластера: задачу и блоки ключей выдает координатор
+    if (!workerAddress.empty()) {
+        if (hasMaskArgs || !patternsFile.empty() || !scoreModeName.empty() || !splitKeyHex.empty() ||
+            !checkpointPath.empty() || !coordinatorAddress.empty() || !create2Deployer.empty() || contract) {
+            std::cerr << "Ошибка: задачу рабочему процессу задает координатор" << std::endl;
+            return 1;
+        }
+#ifndef _WIN32
+        describeKernels(std::cerr);
+        describePlacement(std::cerr);
+        SearchPool pool(numThreads, placement, topology.nodeCount, batchSize);
+        std::unique_ptr<AdaptiveWorkers> adaptive;
+        if (background) {
+            adaptive = std::make_unique<AdaptiveWorkers>(pool, numThreads);
+        }
+        MetricsReporter metrics(pool);
+        if (!startMetrics(metrics)) {
             return 1;
         }
+        auto profiler = startProfile(pool);
+        ClusterWorker worker(pool, verifyAddressFromPrivateKey);
+        return worker.run(workerAddress);
+#else
+        std::cerr << "Ошибка: кластер не поддерживается на этой платформе" << std::endl;
+        return 1;
+#endif
     }
     
-    // Сохраняем оригинальные маски для проверки регистра
-    std::string prefixMaskOriginal = prefixMask;
-    std::string suffixMaskOriginal = suffixMask;
+    // В формате json в stdout идут только строки результатов
+    std::ostream& log = jsonOutput ? std::cerr : std::cout;
+    log << "=== Генератор Vanity Адресов BEP20 (Оптимизированная версия) ===" << std::endl;
     
-    // Проверяем, есть ли заглавные буквы в маске (значит нужно учитывать регистр)
-    bool hasUpperCase = false;
-    for (char c : prefixMask) {
-        if (c >= 'A' && c <= 'F') {
-            hasUpperCase = true;
-            break;
+    int modes = (hasMaskArgs ? 1 : 0) + (!patternsFile.empty() ? 1 : 0) + (!scoreModeName.empty() ? 1 : 0);
+    if (modes > 1) {
+        std::cerr << "Ошибка: маску, --patterns и --score нельзя использовать вместе" << std::endl;
+        return 1;
+    }
+    if (tron && modes > (hasMaskArgs ? 1 : 0)) {
+        std::cerr << "Ошибка: --tron работает только с --prefix/--suffix" << std::endl;
+        return 1;
+    }
+    bool create2 = !create2Deployer.empty() || !initCodeHash.empty();
+    if (contract) {
+        if (tron || create2) {
+            std::cerr << "Ошибка: --contract не работает с --tron и --create2" << std::endl;
+            return 1;
+        }
+        if (maxNonce >= static_cast<long long>(MAX_CONTRACT_NONCES)) {
+            std::cerr << "Ошибка: --max-nonce должен быть меньше " << MAX_CONTRACT_NONCES << std::endl;
+            return 1;
+        }
+        job->contractNonces = static_cast<size_t>(std::max(0LL, maxNonce) + 1);
+    }
+    if (create2) {
+        // Соль - не ключ: разделенный ключ, блоки ключей и кластер к ней неприменимы,
+        // а случайные соли не повторяются и без контрольной точки
+        if (tron || modes > (hasMaskArgs ? 1 : 0) || !splitKeyHex.empty()) {
+            std::cerr << "Ошибка: --create2 работает только с --prefix/--suffix" << std::endl;
+            return 1;
+        }
+        if (!checkpointPath.empty() || !coordinatorAddress.empty()) {
+            std::cerr << "Ошибка: --create2 не поддерживает --checkpoint и --coordinator" << std::endl;
+            return 1;
         }
     }
-    if (!hasUpperCase) {
-        for (char c : suffixMask) {
-            if (c >= 'A' && c <= 'F') {
-                hasUpperCase = true;
-                break;
+    
+    std::string error;
+    if (!scoreModeName.empty()) {
+        // Маска не нужна: ищем адрес с наибольшим счетом
+        if (!parseScoreMode(scoreModeName, job->scoreMode)) {
+            std::cerr << "Ошибка: неизвестный режим счета: " << scoreModeName << std::endl;
+            return 1;
+        }
+        job->kind = SearchKind::Score;
+    } else if (!patternsFile.empty()) {
+        job->kind = SearchKind::Patterns;
+        // По умолчанию ищем все шаблоны набора
+        if (!hasResultLimit) {
+            job->resultLimit = 0;
+        }
+        if (!job->patterns.loadFile(patternsFile, error)) {
+            std::cerr << "Ошибка: " << error << std::endl;
+            return 1;
+        }
+        if (job->patterns.empty()) {
+            std::cerr << "Ошибка: файл шаблонов не содержит шаблонов" << std::endl;
+            return 1;
+        }
+    } else if (tron) {
+        // Адрес TRON в base58: маска сравнивается с 20 байтами адреса без кодирования
+        job->kind = SearchKind::Tron;
+        if (!hasMaskArgs) {
+            std::cerr << "Ошибка: --tron требует --prefix и/или --suffix" << std::endl;
+            return 1;
+        }
+        if (job->resultLimit == 0) {
+            std::cerr << "Ошибка: --count должен быть больше 0" << std::endl;
+            return 1;
+        }
+        if (!compileTronMask(prefixMask, suffixMask, job->tronMask, error)) {
+            std::cerr << "Ошибка: " << error << std::endl;
+            return 1;
+        }
+    } else {
+        if (!hasMaskArgs) {
+            std::cout << "Введите начало адреса после 0x (? - любой символ, - - не задано): ";
+            std::cin >> prefixMask;
+            
+            std::cout << "Введите конец адреса (? - любой символ, - - не задано): ";
+            std::cin >> suffixMask;
+            
+            if (prefixMask == "-") prefixMask.clear();
+            if (suffixMask == "-") suffixMask.clear();
+        }
+        
+        // Валидация и заполнение структуры маски
+        Mask mask;
+        if (!parseMask(prefixMask, suffixMask, mask, error)) {
+            std::cerr << "Ошибка: " << error << std::endl;
+            return 1;
+        }
+        if (job->resultLimit == 0) {
+            std::cerr << "Ошибка: --count должен быть больше 0" << std::endl;
+            return 1;
+        }
+        
+        // Компилируем маску один раз для горячего цикла
+        job->mask = compileMask(mask);
+        
+        if (create2) {
+            job->kind = SearchKind::Create2;
+            if (!parseCreate2Params(create2Deployer, initCodeHash, job->create2, error)) {
+                std::cerr << "Ошибка: " << error << std::endl;
+                return 1;
             }
         }
     }
     
-    globalMask.checkCase = hasUpperCase;
-    globalMask.suffixLength = suffixMaskOriginal.length();
+    // Разделенный ключ: приватный ключ остается у клиента, ищем только смещение
+    if (!splitKeyHex.empty() && !parsePublicKeyHex(splitKeyHex, job->basePoint, error)) {
+        std::cerr << "Ошибка: " << error << std::endl;
+        return 1;
+    }
     
-    // Заполняем структуру маски
-    for (int i = 0; i < 2; i++) {
-        if (prefixMaskOriginal[i] == '?') {
-            globalMask.prefixWildcard[i] = true;
-            globalMask.prefix[i] = 0;
-            globalMask.prefixCaseSensitive[i] = false;
-        } else {
-            globalMask.prefixWildcard[i] = false;
-            globalMask.prefix[i] = prefixMaskOriginal[i];
-            // Если символ заглавный, значит нужно учитывать регистр
-            globalMask.prefixCaseSensitive[i] = (prefixMaskOriginal[i] >= 'A' && prefixMaskOriginal[i] <= 'F');
+    // Контрольная точка: описание задачи должно совпадать при возобновлении
+    std::shared_ptr<KeyspacePartition> partition;
+    if (resume && checkpointPath.empty()) {
+        std::cerr << "Ошибка: --resume требует --checkpoint <файл>" << std::endl;
+        return 1;
+    }
+    std::ostringstream spec;
+    if (job->kind == SearchKind::Score) {
+        spec << "score " << scoreModeName << " target=" << job->scoreTarget;
+    } else if (job->kind == SearchKind::Patterns) {
+        spec << "patterns";
+        for (const std::string& text : job->patterns.texts) {
+            spec << " " << text;
         }
+        spec << " limit=" << job->resultLimit;
+    } else if (job->kind == SearchKind::Tron) {
+        spec << "tron " << prefixMask << "..." << suffixMask << " count=" << job->resultLimit;
+    } else {
+        spec << "mask " << prefixMask << "..." << suffixMask << " count=" << job->resultLimit;
     }
-    
-    for (int i = 0; i < globalMask.suffixLength; i++) {
-        if (suffixMaskOriginal[i] == '?') {
-            globalMask.suffixWildcard[i] = true;
-            globalMask.suffix[i] = 0;
-            globalMask.suffixCaseSensitive[i] = false;
+    if (job->splitKey()) {
+        spec << " split=" << publicKeyToHex(job->basePoint);
+    }
+    if (job->contractNonces > 0) {
+        spec << " contract=" << job->contractNonces;
+    }
+    if (!checkpointPath.empty()) {
+        if (resume) {
+            partition = KeyspacePartition::load(checkpointPath, error);
+            if (!partition) {
+                std::cerr << "Ошибка: " << error << std::endl;
+                return 1;
+            }
+            if (partition->spec != spec.str()) {
+                std::cerr << "Ошибка: контрольная точка создана для другой задачи: " << partition->spec << std::endl;
+                return 1;
+            }
+            if (partition->previous.complete) {
+                std::cerr << "Поиск по контрольной точке уже завершен" << std::endl;
+                return 0;
+            }
+            // Восстанавливаем найденное в прошлых запусках
+            job->hits = partition->previous.hits;
+            job->bestScore.store(partition->previous.bestScore);
+            if (job->kind == SearchKind::Patterns) {
+                job->patternSatisfied.assign(job->patterns.size(), false);
+                for (size_t index : partition->previous.patternsFound) {
+                    if (index < job->patterns.size()) job->patternSatisfied[index] = true;
+                }
+            }
         } else {
-            globalMask.suffixWildcard[i] = false;
-            globalMask.suffix[i] = suffixMaskOriginal[i];
-            // Если символ заглавный, значит нужно учитывать регистр
-            globalMask.suffixCaseSensitive[i] = (suffixMaskOriginal[i] >= 'A' && suffixMaskOriginal[i] <= 'F');
+            if (std::filesystem::exists(checkpointPath)) {
+                std::cerr << "Ошибка: контрольная точка уже существует, используйте --resume: "
+                          << checkpointPath << std::endl;
+                return 1;
+            }
+            partition = KeyspacePartition::create(spec.str());
         }
+        job->partition = partition;
+    }
+    // Задача для рабочих процессов кластера: поля запроса сервера задач (см. server.h)
+    std::ostringstream clusterFields;
+    if (job->kind == SearchKind::Score) {
+        clusterFields << "\"score\": " << jsonString(scoreModeName) << ", \"target\": " << job->scoreTarget;
+    } else if (job->kind == SearchKind::Patterns) {
+        // Шаблоны - строками "префикс суффикс", как в файле (texts хранит вид "префикс...суффикс")
+        clusterFields << "\"patterns\": [";
+        for (size_t i = 0; i < job->patterns.texts.size(); i++) {
+            const std::string& text = job->patterns.texts[i];
+            size_t dots = text.find("...");
+            std::string prefix = text.substr(0, dots), suffix = text.substr(dots + 3);
+            clusterFields << (i ? ", " : "") << jsonString((prefix.empty() ? "-" : prefix) + " " +
+                                                           (suffix.empty() ? "-" : suffix));
+        }
+        clusterFields << "], \"limit\": " << job->resultLimit;
+    } else {
+        clusterFields << "\"prefix\": " << jsonString(prefixMask) << ", \"suffix\": " << jsonString(suffixMask)
+                      << ", \"count\": " << job->resultLimit;
+        if (job->kind == SearchKind::Tron) {
+            clusterFields << ", \"tron\": true";
+        }
+    }
+    if (job->splitKey()) {
+        clusterFields << ", \"split_key\": " << jsonString(publicKeyToHex(job->basePoint));
+    }
+    if (job->contractNonces > 0) {
+        clusterFields << ", \"max_nonce\": " << job->contractNonces - 1;
     }
     
-    // Определяем количество потоков
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0) numThreads = 4; // Fallback если не можем определить
+    // Запись контрольной точки с учетом прошлых запусков
+    auto saveCheckpoint = [&](bool final) {
+        CheckpointStats stats;
+        stats.attempts = partition->previous.attempts + job->attemptCount();
+        stats.seconds = partition->previous.seconds + job->elapsedSeconds();
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            stats.hits = job->hits;
+            stats.bestScore = job->bestScore.load();
+            for (size_t i = 0; i < job->patternSatisfied.size(); i++) {
+                if (job->patternSatisfied[i]) stats.patternsFound.push_back(i);
+            }
+            stats.complete = final && job->reason == StopReason::Complete;
+        }
+        std::string saveError;
+        if (!partition->save(checkpointPath, stats, saveError)) {
+            std::cerr << "\nОшибка: " << saveError << std::endl;
+        }
+    };
     
-    std::cout << "\nПоиск адреса с маской: " << prefixMaskOriginal << "..." << suffixMaskOriginal << std::endl;
-    if (globalMask.checkCase) {
-        std::cout << "Регистр учитывается (EIP-55 checksum)" << std::endl;
+    if (job->kind == SearchKind::Score) {
+        log << "\nПоиск лучшего адреса, целевой счет: " << job->scoreTarget << std::endl;
+    } else if (job->kind == SearchKind::Patterns) {
+        log << "\nПоиск по набору шаблонов: " << job->patterns.size() << " шт." << std::endl;
+    } else if (job->kind == SearchKind::Tron) {
+        log << "\nПоиск адреса TRON: " << prefixMask << "..." << suffixMask << std::endl;
+    } else if (job->kind == SearchKind::Create2) {
+        log << "\nПоиск адреса контракта CREATE2: " << prefixMask << "..." << suffixMask << std::endl;
+        log << "Деплоер: " << addressBytesToHex(job->create2.deployer) << ", хеш init-кода: 0x";
+        for (uint8_t byte : job->create2.initCodeHash) {
+            log << hexChars[byte >> 4] << hexChars[byte & 0x0F];
+        }
+        log << std::endl;
+        if (job->mask.upperCount > 0) {
+            log << "Регистр учитывается (EIP-55 checksum)" << std::endl;
+        }
+    } else {
+        log << "\nПоиск адреса с маской: " << prefixMask << "..." << suffixMask << std::endl;
+        if (job->mask.upperCount > 0) {
+            log << "Регистр учитывается (EIP-55 checksum)" << std::endl;
+        }
     }
-    std::cout << "Используется потоков: " << numThreads << std::endl;
-    std::cout << "Запуск генерации..." << std::endl;
-    
-    auto startTime = std::chrono::steady_clock::now();
-    auto lastReportTime = startTime;
+    if (job->splitKey()) {
+        log << "Разделенный ключ: " << publicKeyToHex(job->basePoint)
+            << " (результат - смещение k, итоговый ключ = ключ клиента + k mod n)" << std::endl;
+    }
+    if (job->contractNonces > 0) {
+        log << "Маска проверяется для адресов контрактов ключа (CREATE, nonce 0";
+        if (job->contractNonces > 1) {
+            log << ".." << job->contractNonces - 1;
+        }
+        log << ")" << std::endl;
+    }
+    if (!coordinatorAddress.empty()) {
+        log << "Координатор кластера: " << coordinatorAddress << ", рабочие: --worker " << coordinatorAddress << std::endl;
+    } else {
+        log << "Используется потоков: " << numThreads;
+        if (double limit = cgroupCpuLimit(); limit > 0) {
+            log << " (квота cgroup: " << std::setprecision(2) << limit << " CPU)";
+        }
+        if (background) {
+            log << ", фоновый режим";
+        }
+        log << ", пакет: " << batchSize << (job->kind == SearchKind::Create2 ? " солей" : " точек") << std::endl;
+        describeKernels(log);
+        describePlacement(log);
+    }
+    if (partition) {
+        log << "Контрольная точка: " << checkpointPath;
+        if (resume) {
+            log << " (продолжение: " << partition->completedChunks() << " блоков по "
+                << KeyspacePartition::CHUNK_KEYS << " ключей уже проверено)";
+        }
+        log << std::endl;
+    }
+    log << "Запуск генерации..." << std::endl;
+    
+    // Найденные по маске адреса выводятся в конце, остальное - по мере нахождения
+    std::vector<SearchHit> maskResults;
+    job->onHit = [&](const SearchJob& job, const SearchHit& hit) {
+        if (jsonOutput) {
+            std::cout << hitToJson(job, hit, verifyAddressFromPrivateKey) << std::endl;
+        } else if (job.kind == SearchKind::Mask || job.kind == SearchKind::Tron || job.kind == SearchKind::Create2) {
+            maskResults.push_back(hit);
+        } else {
+            printHitText(job, hit);
+        }
+    };
     
-    // Запускаем рабочие потоки
-    std::vector<std::thread> threads;
-    for (unsigned int i = 0; i < numThreads; i++) {
-        threads.emplace_back(workerThread, i, numThreads);
+    // Координатор кластера ищет руками рабочих процессов: своего пула потоков у него нет
+    std::unique_ptr<SearchPool> pool;
+    std::unique_ptr<AdaptiveWorkers> adaptive;
+    std::unique_ptr<MetricsReporter> metrics;
+    std::unique_ptr<ProfileReporter> profiler;
+#ifndef _WIN32
+    std::unique_ptr<ClusterCoordinator> coordinator;
+    if (!coordinatorAddress.empty()) {
+        coordinator = std::make_unique<ClusterCoordinator>(
+            job, partition ? partition : KeyspacePartition::create(spec.str()), clusterFields.str(),
+            verifyAddressFromPrivateKey, log);
+        if (!coordinator->listen(coordinatorAddress, error)) {
+            std::cerr << "Ошибка: " << error << std::endl;
+            return 1;
+        }
+        coordinator->start();
+    }
+#endif
+    if (coordinatorAddress.empty()) {
+        pool = std::make_unique<SearchPool>(numThreads, placement, topology.nodeCount, batchSize);
+        if (background) {
+            adaptive = std::make_unique<AdaptiveWorkers>(*pool, numThreads);
+        }
+        metrics = std::make_unique<MetricsReporter>(*pool);
+        if (!startMetrics(*metrics)) {
+            return 1;
+        }
+        profiler = startProfile(*pool);
+        pool->submit(job);
     }
     
     // Поток для отображения прогресса
     std::thread progressThread([&]() {
-        while (!found.load()) {
+        auto lastCheckpoint = std::chrono::steady_clock::now();
+        while (!job->stopped.load()) {
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
             
-            auto now = std::chrono::steady_clock::now();
-            auto totalElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
-            auto reportElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastReportTime).count();
+            if (partition && std::chrono::steady_clock::now() - lastCheckpoint >=
+                                 std::chrono::duration<double>(checkpointInterval)) {
+                saveCheckpoint(false);
+                lastCheckpoint = std::chrono::steady_clock::now();
+            }
             
-            long long currentAttempts = totalAttempts.load();
+            double totalSeconds = job->elapsedSeconds();
+            long long currentAttempts = job->attemptCount();
             
-            if (totalElapsed > 0 && reportElapsed > 0) {
-                double totalSeconds = totalElapsed / 1000.0;
-                double speed = currentAttempts / totalSeconds;
+            if (totalSeconds > 0 && !job->stopped.load()) {
+                // Сглаженная скорость появляется после первых замеров
+                double speed = metrics ? metrics->currentRate() : 0;
+#ifndef _WIN32
+                if (coordinator) {
+                    speed = coordinator->rate();
+                }
+#endif
+                if (speed <= 0) {
+                    speed = currentAttempts / totalSeconds;
+                }
+                double eta = etaSeconds(job->hitProbability(), speed, 0.5);
                 
-                std::cout << "\rПопыток: " << currentAttempts 
-                         << " | Скорость: " << std::fixed << std::setprecision(0) << speed 
-                         << " адр/сек | Время: " << std::setprecision(1) << totalSeconds << "с" << std::flush;
+                log << "\rПопыток: " << currentAttempts 
+                    << " | Скорость: " << std::fixed << std::setprecision(0) << speed 
+                    << " адр/сек | Время: " << std::setprecision(1) << totalSeconds << "с";
+                if (eta >= 0) {
+                    log << " | 50% за: " << std::setprecision(0) << eta << "с";
+                }
+#ifndef _WIN32
+                if (coordinator) {
+                    log << " | Рабочих: " << coordinator->workerCount();
+                }
+#endif
+                log << "   " << std::flush;
             }
         }
     });
     
-    // Ждем завершения всех потоков
-    for (auto& t : threads) {
-        t.join();
+    // Ждем завершения задачи
+    job->wait();
+    progressThread.join();
+    if (partition) {
+        saveCheckpoint(true);
+    }
+    if (profiler) {
+        profiler->finish();
     }
     
-    found.store(true); // Останавливаем поток прогресса
-    progressThread.join();
+    auto seconds = static_cast<long long>(job->durationSeconds);
     
-    auto elapsed = std::chrono::steady_clock::now() - startTime;
-    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
+    if (jsonOutput) {
+        std::cout << finishToJson(*job) << std::endl;
+        return job->hits > 0 ? 0 : 1;
+    }
     
-    if (foundResult.found) {
-        // Проверяем правильность вычисления адреса
-        std::string verifiedAddress = verifyAddressFromPrivateKey(foundResult.privateKey);
-        std::string computedAddress = addressBytesToHex(foundResult.addressBytes);
-        
-        std::cout << "\n\n✓ Адрес найден!" << std::endl;
-        
-        // Выводим адрес с checksum, если нужно
-        std::string addressToShow = globalMask.checkCase ? 
-            getAddressWithChecksum(foundResult.addressBytes) : 
-            computedAddress;
-        std::cout << "Адрес: " << addressToShow << std::endl;
-        if (globalMask.checkCase) {
-            std::cout << "Адрес (lowercase): " << computedAddress << std::endl;
+    if (job->reason == StopReason::Timeout) {
+        std::cout << "\n\nИстекло время поиска" << std::endl;
+    }
+#ifndef _WIN32
+    if (coordinator) {
+        std::cout << std::endl;
+        coordinator->printSummary(std::cout);
+    }
+#endif
+    if (partition) {
+        std::cout << "\nВсего с учетом прошлых запусков: " << partition->previous.attempts + job->attemptCount()
+                  << " попыток, " << partition->completedChunks() << " блоков проверено" << std::endl;
+    }
+    
+    if (job->kind == SearchKind::Score) {
+        std::cout << "\n\nЛучший счет: " << job->bestScore.load() << std::endl;
+        std::cout << "Попыток: " << job->attemptCount() << std::endl;
+        std::cout << "Время: " << seconds << " секунд" << std::endl;
+        std::cout << "\n⚠ ВНИМАНИЕ: Сохраните приватные ключи в безопасном месте!" << std::endl;
+        return job->hits > 0 ? 0 : 1;
+    }
+    
+    if (job->kind == SearchKind::Patterns) {
+        std::cout << "\n\nНайдено шаблонов: " << job->hits << " из " << job->patterns.size() << std::endl;
+        std::cout << "Попыток: " << job->attemptCount() << std::endl;
+        std::cout << "Время: " << seconds << " секунд" << std::endl;
+        std::cout << "\n⚠ ВНИМАНИЕ: Сохраните приватные ключи в безопасном месте!" << std::endl;
+        return job->hits > 0 ? 0 : 1;
+    }
+    
+    if (!maskResults.empty()) {
+        for (const SearchHit& hit : maskResults) {
+            printMaskResult(*job, hit);
         }
-        std::cout << "Приватный ключ: " << privateKeyToHex(foundResult.privateKey) << std::endl;
         
-        // Проверка правильности
-        if (verifiedAddress == computedAddress) {
-            std::cout << "✓ Проверка: адрес вычислен правильно" << std::endl;
+        std::cout << "Попыток: " << job->attemptCount() << std::endl;
+        std::cout << "Время: " << seconds << " секунд" << std::endl;
+        if (job->kind == SearchKind::Create2) {
+            std::cout << "\nДеплой: CREATE2 из контракта деплоера с этой солью и тем же init-кодом" << std::endl;
+        } else if (job->splitKey()) {
+            std::cout << "\nИтоговый приватный ключ: ваш приватный ключ + k (mod n)" << std::endl;
         } else {
-            std::cout << "⚠ ОШИБКА: адрес не совпадает с проверкой!" << std::endl;
-            std::cout << "  Вычисленный: " << computedAddress << std::endl;
-            std::cout << "  Проверенный: " << verifiedAddress << std::endl;
+            std::cout << "\n⚠ ВНИМАНИЕ: Сохраните приватный ключ в безопасном месте!" << std::endl;
+            std::cout << "Никому не показывайте приватный ключ!" << std::endl;
         }
-        
-        std::cout << "Попыток: " << totalAttempts.load() << std::endl;
-        std::cout << "Время: " << seconds << " секунд" << std::endl;
-        std::cout << "\n⚠ ВНИМАНИЕ: Сохраните приватный ключ в безопасном месте!" << std::endl;
-        std::cout << "Никому не показывайте приватный ключ!" << std::endl;
     } else {
         std::cout << "\nОшибка: адрес не найден" << std::endl;
         return 1;
     }
     
     return 0;
-}
\ No newline at end of file
+}
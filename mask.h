@@ -0,0 +1,462 @@
+// Маски адресов и их быстрая проверка на сырых байтах адреса
+// Маска один раз компилируется в побайтовые маски значения/значимости,
+// так что проверка в нижнем регистре - несколько сравнений 64-битных слов.
+// Checksum EIP-55 (второй Keccak) считается только для кандидатов,
+// уже прошедших проверку без учета регистра.
+
+#ifndef MASK_H
+#define MASK_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+#include "bytes.h"
+#include "keccak.h"
+
+// Маска, введенная пользователем: начало и конец адреса произвольной длины
+// (вместе не более 40 символов). ? - любой символ, заглавная буква A-F - учет регистра
+struct Mask {
+    std::string prefix;  // Символы сразу после 0x
+    std::string suffix;  // Последние символы адреса
+    bool checkCase = false;  // true если нужно проверять регистр
+};
+
+// Хеш EIP-55: Keccak-256 от 40 hex-символов адреса в нижнем регистре
+inline void eip55Hash(const uint8_t* addressBytes, uint8_t* hash) {
+    uint8_t addressLower[40];
+    for (int i = 0; i < 20; i++) {
+        addressLower[2 * i] = hexChars[(addressBytes[i] >> 4) & 0x0F];
+        addressLower[2 * i + 1] = hexChars[addressBytes[i] & 0x0F];
+    }
+    Keccak::keccak256(addressLower, sizeof(addressLower), hash);
+}
+
+// Значение hex-символа маски (регистр не важен)
+inline uint8_t hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+// Скомпилированная маска: значения и значимые биты для всех 20 байт адреса
+struct CompiledMask {
+    uint8_t value[20] = {0};
+    uint8_t care[20] = {0};
+    // Номера nibble (0..39), которые в EIP-55 должны быть заглавными
+    uint8_t upperNibbles[40];
+    int upperCount = 0;
+
+    // Устанавливает nibble с номером position (0 - старший nibble байта 0)
+    void setNibble(int position, uint8_t nibble) {
+        int shift = (position % 2 == 0) ? 4 : 0;
+        value[position / 2] |= static_cast<uint8_t>(nibble << shift);
+        care[position / 2] |= static_cast<uint8_t>(0x0F << shift);
+    }
+
+    template <typename T>
+    static T load(const uint8_t* p) {
+        T word;
+        memcpy(&word, p, sizeof(T));
+        return word;
+    }
+
+    // Проверка без учета регистра: маскированные сравнения слов 0..7, 8..15, 16..19
+    bool matchesLower(const uint8_t* addressBytes) const {
+        return (((load<uint64_t>(addressBytes) ^ load<uint64_t>(value)) & load<uint64_t>(care)) |
+                ((load<uint64_t>(addressBytes + 8) ^ load<uint64_t>(value + 8)) & load<uint64_t>(care + 8)) |
+                ((load<uint32_t>(addressBytes + 16) ^ load<uint32_t>(value + 16)) & load<uint32_t>(care + 16))) == 0;
+    }
+
+    // Проверка регистра EIP-55 для адреса, уже прошедшего matchesLower
+    bool matchesChecksum(const uint8_t* addressBytes) const {
+        uint8_t hash[32];
+        eip55Hash(addressBytes, hash);
+        for (int i = 0; i < upperCount; i++) {
+            int position = upperNibbles[i];
+            uint8_t hashNibble = (position % 2 == 0) ?
+                (hash[position / 2] >> 4) : (hash[position / 2] & 0x0F);
+            if (hashNibble < 8) return false;
+        }
+        return true;
+    }
+
+    bool matches(const uint8_t* addressBytes) const {
+        if (!matchesLower(addressBytes)) return false;
+        return upperCount == 0 || matchesChecksum(addressBytes);
+    }
+
+    int fixedNibbles() const {
+        int count = 0;
+        for (uint8_t byte : care) {
+            count += std::popcount(byte) / 4;
+        }
+        return count;
+    }
+
+    // Вероятность совпадения случайного адреса: 16^-fixed * 2^-upper
+    double probability() const {
+        return std::pow(16.0, -fixedNibbles()) * std::pow(2.0, -upperCount);
+    }
+
+    // Маска "почти совпадения": без последнего заданного nibble и без регистра.
+    // Частота таких адресов в 16 раз выше частоты совпадений и позволяет
+    // следить за работой поиска задолго до первого результата
+    CompiledMask nearMiss() const {
+        CompiledMask near = *this;
+        near.upperCount = 0;
+        for (int position = 39; position >= 0; position--) {
+            int shift = (position % 2 == 0) ? 4 : 0;
+            if (near.care[position / 2] & (0x0F << shift)) {
+                near.care[position / 2] &= static_cast<uint8_t>(~(0x0F << shift));
+                near.value[position / 2] &= static_cast<uint8_t>(~(0x0F << shift));
+                break;
+            }
+        }
+        return near;
+    }
+};
+
+// Компиляция маски: символ задает nibble, заглавная буква A-F - еще и регистр
+inline CompiledMask compileMask(const Mask& mask) {
+    CompiledMask compiled;
+    auto addChar = [&](int position, char c) {
+        if (c == '?') {
+            return;
+        }
+        compiled.setNibble(position, hexNibble(c));
+        if (c >= 'A' && c <= 'F') {
+            compiled.upperNibbles[compiled.upperCount++] = static_cast<uint8_t>(position);
+        }
+    };
+    
+    for (size_t i = 0; i < mask.prefix.length(); i++) {
+        addChar(static_cast<int>(i), mask.prefix[i]);
+    }
+    int suffixStart = 40 - static_cast<int>(mask.suffix.length());
+    for (size_t i = 0; i < mask.suffix.length(); i++) {
+        addChar(suffixStart + static_cast<int>(i), mask.suffix[i]);
+    }
+    return compiled;
+}
+
+// Разбор и проверка маски: начало и конец адреса любой длины (0-9, a-f, A-F, ?),
+// вместе не более 40 символов. При ошибке возвращает false и текст ошибки в error
+inline bool parseMask(const std::string& prefixMask, const std::string& suffixMask,
+                      Mask& mask, std::string& error) {
+    if (prefixMask.empty() && suffixMask.empty()) {
+        error = "маска должна задавать начало или конец адреса";
+        return false;
+    }
+    
+    if (prefixMask.length() + suffixMask.length() > 40) {
+        error = "префикс и суффикс вместе не могут быть длиннее 40 символов";
+        return false;
+    }
+    
+    auto isValidHexChar = [](char c) {
+        return (c >= '0' && c <= '9') || 
+               (c >= 'a' && c <= 'f') || 
+               (c >= 'A' && c <= 'F') || 
+               c == '?';
+    };
+    
+    for (char c : prefixMask) {
+        if (!isValidHexChar(c)) {
+            error = std::string("недопустимый символ в префиксе: ") + c;
+            return false;
+        }
+    }
+    
+    for (char c : suffixMask) {
+        if (!isValidHexChar(c)) {
+            error = std::string("недопустимый символ в суффиксе: ") + c;
+            return false;
+        }
+    }
+    
+    // Заглавная буква в маске означает, что нужно учитывать регистр (EIP-55)
+    mask.prefix = prefixMask;
+    mask.suffix = suffixMask;
+    mask.checkCase = false;
+    for (char c : prefixMask + suffixMask) {
+        mask.checkCase |= (c >= 'A' && c <= 'F');
+    }
+    
+    return true;
+}
+
+// Проверка маски, специализированная по форме шаблона на этапе компиляции:
+// Head/Middle/Tail - используются ли байты 0..7, 8..15, 16..19, CheckCase - нужен ли EIP-55.
+// Для типичной короткой маски остаются два сравнения слов без лишних ветвлений
+template <bool Head, bool Middle, bool Tail, bool CheckCase>
+inline bool matchesShape(const CompiledMask& mask, const uint8_t* addressBytes) {
+    uint64_t diff = 0;
+    if constexpr (Head) {
+        diff |= (CompiledMask::load<uint64_t>(addressBytes) ^ CompiledMask::load<uint64_t>(mask.value)) &
+                CompiledMask::load<uint64_t>(mask.care);
+    }
+    if constexpr (Middle) {
+        diff |= (CompiledMask::load<uint64_t>(addressBytes + 8) ^ CompiledMask::load<uint64_t>(mask.value + 8)) &
+                CompiledMask::load<uint64_t>(mask.care + 8);
+    }
+    if constexpr (Tail) {
+        diff |= (CompiledMask::load<uint32_t>(addressBytes + 16) ^ CompiledMask::load<uint32_t>(mask.value + 16)) &
+                CompiledMask::load<uint32_t>(mask.care + 16);
+    }
+    if (diff != 0) {
+        return false;
+    }
+    if constexpr (CheckCase) {
+        return mask.matchesChecksum(addressBytes);
+    }
+    return true;
+}
+
+// Форма маски: биты 0-2 - используемые слова адреса, бит 3 - проверка регистра
+inline int maskShape(const CompiledMask& mask) {
+    auto used = [&](int from, int to) {
+        for (int i = from; i < to; i++) {
+            if (mask.care[i]) return true;
+        }
+        return false;
+    };
+    return (used(0, 8) ? 1 : 0) | (used(8, 16) ? 2 : 0) | (used(16, 20) ? 4 : 0) |
+           (mask.upperCount > 0 ? 8 : 0);
+}
+
+template <int Shape, typename F>
+inline void callWithShape(const CompiledMask& mask, F& body) {
+    body([&mask](const uint8_t* addressBytes) {
+        return matchesShape<(Shape & 1) != 0, (Shape & 2) != 0, (Shape & 4) != 0, (Shape & 8) != 0>(
+            mask, addressBytes);
+    });
+}
+
+template <typename F, int... Shapes>
+inline void dispatchShape(int shape, const CompiledMask& mask, F& body, std::integer_sequence<int, Shapes...>) {
+    ((shape == Shapes ? (callWithShape<Shapes>(mask, body), 0) : 0), ...);
+}
+
+// Вызывает body(matcher), где matcher(addressBytes) - проверка, специализированная под
+// форму маски. Выбор формы выполняется один раз на вызов, а не на каждый адрес
+template <typename F>
+inline void withMaskMatcher(const CompiledMask& mask, F&& body) {
+    dispatchShape(maskShape(mask), mask, body, std::make_integer_sequence<int, 16>());
+}
+
+// Режимы поиска "лучшего" адреса: счет считается по сырым 20 байтам адреса
+enum class ScoreMode {
+    LeadingZeros,   // Количество ведущих нулевых nibble
+    ZeroBytes,      // Количество нулевых байт в адресе (дешевле calldata)
+    LeadingRepeat   // Количество ведущих nibble, равных первому
+};
+
+// Количество ведущих nibble адреса, равных соответствующим nibble pattern
+// (pattern - повторяющийся nibble, например 0 для нулей)
+inline int leadingNibbles(const uint8_t* addressBytes, uint64_t pattern) {
+    uint64_t w = loadBE64(addressBytes) ^ pattern;
+    if (w != 0) return std::countl_zero(w) / 4;
+    w = loadBE64(addressBytes + 8) ^ pattern;
+    if (w != 0) return 16 + std::countl_zero(w) / 4;
+    // Байты 16..19 - младшая половина слова 12..19
+    w = (loadBE64(addressBytes + 12) ^ pattern) << 32;
+    if (w != 0) return 32 + std::countl_zero(w) / 4;
+    return 40;
+}
+
+inline int scoreAddress(ScoreMode mode, const uint8_t* addressBytes) {
+    switch (mode) {
+    case ScoreMode::LeadingZeros:
+        return leadingNibbles(addressBytes, 0);
+    case ScoreMode::ZeroBytes: {
+        int zeros = 0;
+        for (int i = 0; i < 20; i++) {
+            zeros += addressBytes[i] == 0;
+        }
+        return zeros;
+    }
+    case ScoreMode::LeadingRepeat:
+        return leadingNibbles(addressBytes, 0x1111111111111111ULL * (addressBytes[0] >> 4));
+    }
+    return 0;
+}
+
+// Вероятность того, что случайный адрес наберет счет не меньше target
+inline double scoreProbability(ScoreMode mode, int target) {
+    switch (mode) {
+    case ScoreMode::LeadingZeros:
+        return std::pow(16.0, -target);
+    case ScoreMode::ZeroBytes: {
+        // Биномиальное распределение: 20 байт, каждый равен нулю с вероятностью 1/256
+        double p = 0;
+        double binomial = 1;
+        for (int k = 0; k <= 20; k++) {
+            if (k >= target) {
+                p += binomial * std::pow(1.0 / 256, k) * std::pow(255.0 / 256, 20 - k);
+            }
+            binomial = binomial * (20 - k) / (k + 1);
+        }
+        return p;
+    }
+    case ScoreMode::LeadingRepeat:
+        return target <= 1 ? 1.0 : std::pow(16.0, 1 - target);
+    }
+    return 0;
+}
+
+// Имя режима из командной строки: zeros, zero-bytes, repeat
+inline bool parseScoreMode(const std::string& name, ScoreMode& mode) {
+    if (name == "zeros") { mode = ScoreMode::LeadingZeros; return true; }
+    if (name == "zero-bytes") { mode = ScoreMode::ZeroBytes; return true; }
+    if (name == "repeat") { mode = ScoreMode::LeadingRepeat; return true; }
+    return false;
+}
+
+// Набор шаблонов для поиска многих масок за один проход.
+// Каждый шаблон попадает в индекс по первому полностью заданному окну адреса
+// (последние 2 байта, первые 2 байта, последний байт, первый байт), так что
+// на один адрес проверяется в среднем несколько кандидатов вместо всех шаблонов.
+struct PatternSet {
+    std::vector<std::string> texts;     // Исходный вид шаблона для вывода
+    std::vector<CompiledMask> masks;
+    
+    // Индекс по окну адреса в виде CSR: шаблоны ключа k - ids[starts[k]..starts[k+1])
+    struct Window {
+        int offset;  // Первый байт окна в адресе
+        int bytes;   // 1 или 2 байта
+        std::vector<uint32_t> starts;
+        std::vector<uint32_t> ids;
+        
+        uint32_t key(const uint8_t* addressBytes) const {
+            return bytes == 2 ? (addressBytes[offset] << 8 | addressBytes[offset + 1]) : addressBytes[offset];
+        }
+    };
+    std::vector<Window> windows;
+    std::vector<uint32_t> unindexed;  // Шаблоны без полностью заданного окна
+    
+    size_t size() const { return masks.size(); }
+    bool empty() const { return masks.empty(); }
+    
+    void add(const std::string& text, const CompiledMask& mask) {
+        texts.push_back(text);
+        masks.push_back(mask);
+    }
+    
+    // Строит индексы после добавления всех шаблонов
+    void build() {
+        const int layout[4][2] = {{18, 2}, {0, 2}, {19, 1}, {0, 1}};
+        std::vector<int> assigned(masks.size(), -1);
+        for (size_t p = 0; p < masks.size(); p++) {
+            for (int w = 0; w < 4; w++) {
+                bool full = true;
+                for (int b = 0; b < layout[w][1]; b++) {
+                    full &= masks[p].care[layout[w][0] + b] == 0xFF;
+                }
+                if (full) {
+                    assigned[p] = w;
+                    break;
+                }
+            }
+        }
+        
+        windows.clear();
+        unindexed.clear();
+        for (int w = 0; w < 4; w++) {
+            Window window{layout[w][0], layout[w][1], {}, {}};
+            size_t keys = size_t(1) << (8 * window.bytes);
+            window.starts.assign(keys + 1, 0);
+            for (size_t p = 0; p < masks.size(); p++) {
+                if (assigned[p] == w) {
+                    window.starts[window.key(masks[p].value) + 1]++;
+                }
+            }
+            for (size_t k = 0; k < keys; k++) {
+                window.starts[k + 1] += window.starts[k];
+            }
+            if (window.starts[keys] == 0) {
+                continue;
+            }
+            window.ids.resize(window.starts[keys]);
+            std::vector<uint32_t> fill(window.starts.begin(), window.starts.end() - 1);
+            for (size_t p = 0; p < masks.size(); p++) {
+                if (assigned[p] == w) {
+                    window.ids[fill[window.key(masks[p].value)]++] = static_cast<uint32_t>(p);
+                }
+            }
+            windows.push_back(std::move(window));
+        }
+        for (size_t p = 0; p < masks.size(); p++) {
+            if (assigned[p] < 0) {
+                unindexed.push_back(static_cast<uint32_t>(p));
+            }
+        }
+    }
+    
+    // Вызывает onMatch(индекс шаблона) для каждого шаблона, которому соответствует адрес
+    template <typename F>
+    void forEachMatch(const uint8_t* addressBytes, F&& onMatch) const {
+        for (const Window& window : windows) {
+            uint32_t k = window.key(addressBytes);
+            for (uint32_t i = window.starts[k]; i < window.starts[k + 1]; i++) {
+                if (masks[window.ids[i]].matches(addressBytes)) {
+                    onMatch(window.ids[i]);
+                }
+            }
+        }
+        for (uint32_t p : unindexed) {
+            if (masks[p].matches(addressBytes)) {
+                onMatch(p);
+            }
+        }
+    }
+    
+    // Добавление шаблона из строки вида "префикс суффикс", "-" вместо префикса
+    // или суффикса - пустая часть; пустые строки и строки с # пропускаются.
+    // После добавления всех шаблонов нужно вызвать build()
+    bool addLine(const std::string& line, std::string& error) {
+        std::istringstream fields(line);
+        std::string prefixMask, suffixMask;
+        if (!(fields >> prefixMask) || prefixMask[0] == '#') {
+            return true;
+        }
+        fields >> suffixMask;
+        if (prefixMask == "-") prefixMask.clear();
+        if (suffixMask == "-") suffixMask.clear();
+        Mask mask;
+        if (!parseMask(prefixMask, suffixMask, mask, error)) {
+            return false;
+        }
+        add(prefixMask + "..." + suffixMask, compileMask(mask));
+        return true;
+    }
+    
+    // Загрузка шаблонов из файла: по одному на строку (см. addLine)
+    bool loadFile(const std::string& path, std::string& error) {
+        std::ifstream in(path);
+        if (!in) {
+            error = "не удалось открыть файл шаблонов: " + path;
+            return false;
+        }
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            std::string lineError;
+            if (!addLine(line, lineError)) {
+                error = "строка " + std::to_string(lineNumber) + ": " + lineError;
+                return false;
+            }
+        }
+        build();
+        return true;
+    }
+};
+
+#endif // MASK_H
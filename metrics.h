@@ -0,0 +1,575 @@
+// Метрики поиска для работы без консоли: сводка счетчиков потоков пула
+// (см. WorkerStats), скорость с экспоненциальным сглаживанием (EWMA) и оценка
+// времени до следующего результата по вероятности совпадения задачи.
+// Отдаются текстом в формате Prometheus и JSON через HTTP на локальном порту
+// или Unix-сокете (GET /metrics, GET /status) и периодически пишутся в файл статуса.
+// Здесь же сводка профиля стадий горячего цикла (--profile, см. profile.h).
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "search.h"
+#include "server.h"
+
+// Время, за которое следующий результат будет найден с вероятностью confidence:
+// число попыток до совпадения распределено геометрически. -1 - оценки нет
+inline double etaSeconds(double probability, double rate, double confidence) {
+    if (probability <= 0 || rate <= 0) {
+        return -1;
+    }
+    if (probability >= 1) {
+        return 0;
+    }
+    return std::log1p(-confidence) / std::log1p(-probability) / rate;
+}
+
+// Сводка метрик на один момент времени
+struct MetricsSnapshot {
+    double uptimeSeconds = 0;
+    double rate = 0;  // EWMA, адресов/сек
+    uint64_t attempts = 0;
+    uint64_t ecOps = 0;
+    uint64_t hashes = 0;
+    uint64_t nearMisses = 0;
+    uint64_t batches = 0;
+    uint64_t latencyMicros = 0;
+    uint64_t latency[WorkerStats::LATENCY_BUCKETS] = {};
+    std::vector<uint64_t> threadAttempts;
+    unsigned int activeWorkers = 0;
+
+    // Текущая задача пула
+    bool hasJob = false;
+    std::string jobId;
+    const char* jobKind = "";
+    long long jobAttempts = 0;
+    size_t jobHits = 0;
+    double jobSeconds = 0;
+    double hitProbability = 0;
+    double nearMissProbability = 0;
+    double eta50 = -1;
+    double eta90 = -1;
+};
+
+class MetricsReporter {
+public:
+    // Время сглаживания скорости: вклад старых замеров убывает как exp(-t / EWMA_SECONDS)
+    static constexpr double EWMA_SECONDS = 10;
+
+    explicit MetricsReporter(SearchPool& pool)
+        : pool(pool), startTime(std::chrono::steady_clock::now()) {}
+
+    ~MetricsReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        stopCondition.notify_all();
+        if (samplerThread.joinable()) {
+            samplerThread.join();
+        }
+#ifndef _WIN32
+        if (listenFd >= 0) {
+            // shutdown будит поток, ждущий в accept
+            ::shutdown(listenFd, SHUT_RDWR);
+            ::close(listenFd);
+        }
+        if (httpThread.joinable()) {
+            httpThread.join();
+        }
+        if (!socketPath.empty()) {
+            ::unlink(socketPath.c_str());
+        }
+#endif
+    }
+
+    MetricsReporter(const MetricsReporter&) = delete;
+    MetricsReporter& operator=(const MetricsReporter&) = delete;
+
+    // Фоновый поток: раз в секунду обновляет EWMA и раз в statusInterval секунд
+    // пишет файл статуса (если statusPath не пуст)
+    void start(const std::string& statusPath = "", double statusInterval = 10) {
+        samplerThread = std::thread([this, statusPath, statusInterval] {
+            auto lastStatus = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopCondition.wait_for(lock, std::chrono::seconds(1), [this] { return stopping; })) {
+                lock.unlock();
+                sample();
+                auto now = std::chrono::steady_clock::now();
+                if (!statusPath.empty() && now - lastStatus >= std::chrono::duration<double>(statusInterval)) {
+                    std::string error;
+                    if (!writeStatusFile(statusPath, error)) {
+                        std::cerr << "\nОшибка: " << error << std::endl;
+                    }
+                    lastStatus = now;
+                }
+                lock.lock();
+            }
+        });
+    }
+
+    // Новый замер суммарного числа попыток для EWMA
+    void sample() {
+        uint64_t attempts = 0;
+        for (unsigned int i = 0; i < pool.threadCount(); i++) {
+            attempts += pool.workerStats(i).attempts.load(std::memory_order_relaxed);
+        }
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sampled) {
+            double dt = std::chrono::duration<double>(now - lastSampleTime).count();
+            if (dt > 0) {
+                double instant = static_cast<double>(attempts - lastSampleAttempts) / dt;
+                double alpha = rateInitialized ? 1 - std::exp(-dt / EWMA_SECONDS) : 1;
+                rate += alpha * (instant - rate);
+                rateInitialized = true;
+            }
+        }
+        sampled = true;
+        lastSampleTime = now;
+        lastSampleAttempts = attempts;
+    }
+
+    double currentRate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rate;
+    }
+
+    MetricsSnapshot snapshot() {
+        MetricsSnapshot s;
+        s.uptimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        s.rate = currentRate();
+        s.activeWorkers = pool.activeLimit();
+        for (unsigned int i = 0; i < pool.threadCount(); i++) {
+            const WorkerStats& stats = pool.workerStats(i);
+            uint64_t attempts = stats.attempts.load(std::memory_order_relaxed);
+            s.threadAttempts.push_back(attempts);
+            s.attempts += attempts;
+            s.ecOps += stats.ecOps.load(std::memory_order_relaxed);
+            s.hashes += stats.hashes.load(std::memory_order_relaxed);
+            s.nearMisses += stats.nearMisses.load(std::memory_order_relaxed);
+            s.batches += stats.batches.load(std::memory_order_relaxed);
+            s.latencyMicros += stats.latencyMicros.load(std::memory_order_relaxed);
+            for (int b = 0; b < WorkerStats::LATENCY_BUCKETS; b++) {
+                s.latency[b] += stats.latency[b].load(std::memory_order_relaxed);
+            }
+        }
+
+        if (std::shared_ptr<SearchJob> job = pool.currentJob()) {
+            s.hasJob = true;
+            s.jobId = job->id;
+            s.jobKind = job->kind == SearchKind::Mask ? "mask" :
+                        job->kind == SearchKind::Patterns ? "patterns" :
+                        job->kind == SearchKind::Tron ? "tron" :
+                        job->kind == SearchKind::Create2 ? "create2" : "score";
+            s.jobAttempts = job->attemptCount();
+            s.jobSeconds = job->elapsedSeconds();
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                s.jobHits = job->hits;
+            }
+            s.hitProbability = job->hitProbability();
+            s.nearMissProbability = job->nearMissProbability();
+            s.eta50 = etaSeconds(s.hitProbability, s.rate, 0.5);
+            s.eta90 = etaSeconds(s.hitProbability, s.rate, 0.9);
+        }
+        return s;
+    }
+
+    // Текстовый формат Prometheus (version 0.0.4)
+    std::string prometheusText() {
+        MetricsSnapshot s = snapshot();
+        std::ostringstream out;
+        out.precision(10);
+        auto metric = [&out](const char* name, const char* type, const char* help) {
+            out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+        };
+        metric("cryptospider_uptime_seconds", "gauge", "Time since start");
+        out << "cryptospider_uptime_seconds " << s.uptimeSeconds << "\n";
+        metric("cryptospider_threads", "gauge", "Worker threads");
+        out << "cryptospider_threads " << s.threadAttempts.size() << "\n";
+        metric("cryptospider_active_workers", "gauge", "Worker threads allowed to run (background mode)");
+        out << "cryptospider_active_workers " << s.activeWorkers << "\n";
+        metric("cryptospider_attempts_total", "counter", "Addresses checked");
+        out << "cryptospider_attempts_total " << s.attempts << "\n";
+        metric("cryptospider_thread_attempts_total", "counter", "Addresses checked per worker thread");
+        for (size_t i = 0; i < s.threadAttempts.size(); i++) {
+            out << "cryptospider_thread_attempts_total{thread=\"" << i << "\"} " << s.threadAttempts[i] << "\n";
+        }
+        metric("cryptospider_ec_ops_total", "counter", "Elliptic curve point additions");
+        out << "cryptospider_ec_ops_total " << s.ecOps << "\n";
+        metric("cryptospider_hashes_total", "counter", "Keccak-256 hashes");
+        out << "cryptospider_hashes_total " << s.hashes << "\n";
+        metric("cryptospider_near_misses_total", "counter", "Addresses matching all but the last mask character");
+        out << "cryptospider_near_misses_total " << s.nearMisses << "\n";
+        metric("cryptospider_rate", "gauge", "Addresses per second, EWMA");
+        out << "cryptospider_rate " << s.rate << "\n";
+
+        metric("cryptospider_batch_duration_seconds", "histogram", "Time to compute and check one walk batch");
+        uint64_t cumulative = 0;
+        for (int b = 0; b < WorkerStats::LATENCY_BUCKETS; b++) {
+            cumulative += s.latency[b];
+            out << "cryptospider_batch_duration_seconds_bucket{le=\"";
+            if (b < WorkerStats::LATENCY_BUCKETS - 1) {
+                out << WorkerStats::LATENCY_BOUNDS[b] / 1e6;
+            } else {
+                out << "+Inf";
+            }
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "cryptospider_batch_duration_seconds_sum " << s.latencyMicros / 1e6 << "\n";
+        out << "cryptospider_batch_duration_seconds_count " << s.batches << "\n";
+
+        metric("cryptospider_job_running", "gauge", "1 while a search job is running");
+        out << "cryptospider_job_running " << (s.hasJob ? 1 : 0) << "\n";
+        if (s.hasJob) {
+            std::string labels = "{id=" + jsonString(s.jobId) + ",kind=\"" + s.jobKind + "\"}";
+            metric("cryptospider_job_attempts", "gauge", "Addresses checked by the current job");
+            out << "cryptospider_job_attempts" << labels << " " << s.jobAttempts << "\n";
+            metric("cryptospider_job_hits", "gauge", "Results found by the current job");
+            out << "cryptospider_job_hits" << labels << " " << s.jobHits << "\n";
+            metric("cryptospider_job_hit_probability", "gauge", "Probability that one address is a result");
+            out << "cryptospider_job_hit_probability" << labels << " " << s.hitProbability << "\n";
+            metric("cryptospider_job_near_miss_probability", "gauge", "Expected near miss ratio");
+            out << "cryptospider_job_near_miss_probability" << labels << " " << s.nearMissProbability << "\n";
+            metric("cryptospider_job_eta_seconds", "gauge", "Time to the next result with the given probability");
+            labels.pop_back();
+            out << "cryptospider_job_eta_seconds" << labels << ",quantile=\"0.5\"} " << s.eta50 << "\n";
+            out << "cryptospider_job_eta_seconds" << labels << ",quantile=\"0.9\"} " << s.eta90 << "\n";
+        }
+        return out.str();
+    }
+
+    std::string statusJson() {
+        MetricsSnapshot s = snapshot();
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        out << "{\"uptime\": " << s.uptimeSeconds << ", \"rate\": " << s.rate
+            << ", \"attempts\": " << s.attempts << ", \"ec_ops\": " << s.ecOps
+            << ", \"hashes\": " << s.hashes << ", \"near_misses\": " << s.nearMisses
+            << ", \"batches\": " << s.batches << ", \"active_workers\": " << s.activeWorkers
+            << ", \"threads\": [";
+        for (size_t i = 0; i < s.threadAttempts.size(); i++) {
+            out << (i ? ", " : "") << s.threadAttempts[i];
+        }
+        out << "]";
+        if (s.hasJob) {
+            out.unsetf(std::ios::fixed);
+            out.precision(6);
+            out << ", \"job\": {\"id\": " << jsonString(s.jobId) << ", \"kind\": \"" << s.jobKind
+                << "\", \"attempts\": " << s.jobAttempts << ", \"hits\": " << s.jobHits
+                << ", \"seconds\": " << s.jobSeconds << ", \"hit_probability\": " << s.hitProbability
+                << ", \"eta50\": " << s.eta50 << ", \"eta90\": " << s.eta90 << "}";
+        } else {
+            out << ", \"job\": null";
+        }
+        out << "}";
+        return out.str();
+    }
+
+    // Файл статуса пишется во временный файл и атомарно заменяется
+    bool writeStatusFile(const std::string& path, std::string& error) {
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::trunc);
+            out << statusJson() << "\n";
+            if (!out) {
+                error = "не удалось записать файл статуса: " + tempPath;
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            error = "не удалось записать файл статуса: " + path;
+            return false;
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    // HTTP-эндпоинт в фоновом потоке. address - порт на 127.0.0.1, "хост:порт"
+    // или путь Unix-сокета (содержит '/')
+    bool serveHttp(const std::string& address, std::string& error) {
+        if (address.find('/') != std::string::npos) {
+            listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un local{};
+            local.sun_family = AF_UNIX;
+            if (listenFd < 0 || address.size() >= sizeof(local.sun_path)) {
+                error = "не удалось открыть сокет метрик: " + address;
+                return false;
+            }
+            std::copy(address.begin(), address.end(), local.sun_path);
+            ::unlink(address.c_str());
+            if (::bind(listenFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+                error = "не удалось открыть сокет метрик: " + address;
+                return false;
+            }
+            socketPath = address;
+        } else {
+            std::string host = "127.0.0.1";
+            std::string port = address;
+            size_t colon = address.rfind(':');
+            if (colon != std::string::npos) {
+                host = address.substr(0, colon);
+                port = address.substr(colon + 1);
+            }
+            sockaddr_in local{};
+            local.sin_family = AF_INET;
+            int portNumber = port.empty() || port.find_first_not_of("0123456789") != std::string::npos ||
+                             port.size() > 5 ? 0 : std::stoi(port);
+            if (portNumber <= 0 || portNumber > 65535 || ::inet_pton(AF_INET, host.c_str(), &local.sin_addr) != 1) {
+                error = "некорректный адрес метрик: " + address;
+                return false;
+            }
+            local.sin_port = htons(static_cast<uint16_t>(portNumber));
+            listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            if (listenFd < 0 ||
+                ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                ::bind(listenFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+                error = "не удалось открыть порт метрик: " + address;
+                return false;
+            }
+        }
+        if (::listen(listenFd, 16) != 0) {
+            error = "не удалось открыть эндпоинт метрик: " + address;
+            return false;
+        }
+        std::signal(SIGPIPE, SIG_IGN);
+        httpThread = std::thread([this] {
+            while (true) {
+                int clientFd = ::accept(listenFd, nullptr, nullptr);
+                if (clientFd < 0) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (stopping) return;
+                    continue;
+                }
+                serveRequest(clientFd);
+                ::close(clientFd);
+            }
+        });
+        return true;
+    }
+#endif
+
+private:
+    SearchPool& pool;
+    std::chrono::steady_clock::time_point startTime;
+
+    std::mutex mutex;
+    std::condition_variable stopCondition;
+    bool stopping = false;
+    std::thread samplerThread;
+
+    // Состояние EWMA, защищено mutex
+    bool sampled = false;
+    bool rateInitialized = false;
+    double rate = 0;
+    std::chrono::steady_clock::time_point lastSampleTime;
+    uint64_t lastSampleAttempts = 0;
+
+#ifndef _WIN32
+    int listenFd = -1;
+    std::string socketPath;
+    std::thread httpThread;
+
+    // Один запрос на соединение: GET /metrics или GET /status
+    void serveRequest(int clientFd) {
+        timeval timeout{2, 0};
+        ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            ssize_t n = ::read(clientFd, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+        std::string path;
+        std::istringstream line(request.substr(0, request.find('\r')));
+        std::string method;
+        line >> method >> path;
+
+        std::string status = "200 OK";
+        std::string contentType = "text/plain; version=0.0.4";
+        std::string body;
+        if (method != "GET") {
+            status = "405 Method Not Allowed";
+            body = "GET only\n";
+        } else if (path == "/metrics" || path == "/") {
+            body = prometheusText();
+        } else if (path == "/status") {
+            contentType = "application/json";
+            body = statusJson() + "\n";
+        } else {
+            status = "404 Not Found";
+            body = "not found\n";
+        }
+        std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+                               "\r\nContent-Length: " + std::to_string(body.size()) +
+                               "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = ::write(clientFd, response.data() + sent, response.size() - sent);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+    }
+#endif
+};
+
+// Сводка профиля стадий (--profile): тики на адрес и доля каждой стадии, p50/p99
+// времени пакета и доля времени, которую каждый поток пула стоит: простаивает без
+// задачи или вытеснен с ядра. Пишется раз в interval секунд и при завершении
+class ProfileReporter {
+public:
+    ProfileReporter(SearchPool& pool, std::ostream& out)
+        : pool(pool), out(out), startTime(std::chrono::steady_clock::now()) {
+        for (unsigned int i = 0; i < pool.threadCount(); i++) {
+            startAttempts += pool.workerStats(i).attempts.load(std::memory_order_relaxed);
+            startBusy.push_back(pool.threadProfile(i).busyNanos.load(std::memory_order_relaxed));
+        }
+        pool.enableProfiling();
+    }
+
+    ~ProfileReporter() {
+        finish();
+    }
+
+    ProfileReporter(const ProfileReporter&) = delete;
+    ProfileReporter& operator=(const ProfileReporter&) = delete;
+
+    // Периодическая сводка; interval <= 0 - только итоговая
+    void start(double interval) {
+        if (interval <= 0) {
+            return;
+        }
+        reporterThread = std::thread([this, interval] {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopCondition.wait_for(lock, std::chrono::duration<double>(interval),
+                                           [this] { return stopping; })) {
+                lock.unlock();
+                out << "\n" << summary() << std::flush;
+                lock.lock();
+            }
+        });
+    }
+
+    // Останавливает периодическую сводку и пишет итоговую (один раз)
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+        }
+        stopCondition.notify_all();
+        if (reporterThread.joinable()) {
+            reporterThread.join();
+        }
+        out << "\n" << summary() << std::flush;
+    }
+
+    std::string summary() const {
+        auto now = std::chrono::steady_clock::now();
+        double wallSeconds = std::chrono::duration<double>(now - startTime).count();
+
+        uint64_t attempts = 0;
+        uint64_t sampledAddresses = 0;
+        uint64_t sampledBatches = 0;
+        uint64_t stageTicks[PROFILE_STAGES] = {};
+        std::vector<uint64_t> histogram;
+        for (unsigned int i = 0; i < pool.threadCount(); i++) {
+            const ThreadProfile& profile = pool.threadProfile(i);
+            attempts += pool.workerStats(i).attempts.load(std::memory_order_relaxed);
+            sampledAddresses += profile.sampledAddresses.load(std::memory_order_relaxed);
+            sampledBatches += profile.sampledBatches.load(std::memory_order_relaxed);
+            for (int s = 0; s < PROFILE_STAGES; s++) {
+                stageTicks[s] += profile.stageTicks[s].load(std::memory_order_relaxed);
+            }
+            profile.batchNanos.addTo(histogram);
+        }
+        attempts -= startAttempts;
+
+        // Старты учитываются все, поэтому делятся на все адреса, остальное - на адреса выборки
+        double perAddress[PROFILE_STAGES] = {};
+        double total = 0;
+        for (int s = 0; s < PROFILE_STAGES; s++) {
+            uint64_t addresses = s == static_cast<int>(ProfileStage::Start) ? attempts : sampledAddresses;
+            perAddress[s] = addresses > 0 ? static_cast<double>(stageTicks[s]) / static_cast<double>(addresses) : 0;
+            total += perAddress[s];
+        }
+
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1);
+        text << "Профиль за " << wallSeconds << " с (выборка: " << sampledBatches << " пакетов, "
+             << sampledAddresses << " адресов)\n";
+        text << "  " << (PROFILE_TICKS_ARE_CYCLES ? "тактов TSC" : "нс") << " на адрес:";
+        for (int s = 0; s < PROFILE_STAGES; s++) {
+            double share = total > 0 ? perAddress[s] / total * 100 : 0;
+            text << " " << profileStageName(static_cast<ProfileStage>(s)) << " " << perAddress[s]
+                 << " (" << share << "%)";
+        }
+        text << ", всего " << total << "\n";
+        text << std::setprecision(3);
+        text << "  пакет: p50 " << static_cast<double>(HdrHistogram::percentile(histogram, 0.5)) / 1e6
+             << " мс, p99 " << static_cast<double>(HdrHistogram::percentile(histogram, 0.99)) / 1e6 << " мс\n";
+        text << std::setprecision(1);
+        for (unsigned int i = 0; i < pool.threadCount(); i++) {
+            const ThreadProfile& profile = pool.threadProfile(i);
+            double busy = static_cast<double>(profile.busyNanos.load(std::memory_order_relaxed) - startBusy[i]) / 1e9;
+            double idle = wallSeconds > 0 ? std::max(0.0, 1 - busy / wallSeconds) : 0;
+            text << "  поток " << i << ": простой " << idle * 100 << "%";
+            uint64_t sampledWall = profile.sampledWallNanos.load(std::memory_order_relaxed);
+            uint64_t sampledCpu = profile.sampledCpuNanos.load(std::memory_order_relaxed);
+            if (sampledWall > 0 && sampledCpu > 0) {
+                double preempted = std::max(0.0, 1 - static_cast<double>(sampledCpu) / static_cast<double>(sampledWall));
+                text << ", вытеснение " << preempted * 100 << "%, стоит " << (idle + (1 - idle) * preempted) * 100
+                     << "%";
+            }
+            text << "\n";
+        }
+        return text.str();
+    }
+
+private:
+    SearchPool& pool;
+    std::ostream& out;
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t startAttempts = 0;
+    std::vector<uint64_t> startBusy;
+
+    std::mutex mutex;
+    std::condition_variable stopCondition;
+    bool stopping = false;
+    std::thread reporterThread;
+};
+
+#endif // METRICS_H
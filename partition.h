@@ -0,0 +1,257 @@
+// Детерминированное разбиение пространства ключей и контрольные точки.
+// Один секретный базовый скаляр B берется из криптостойкого источника,
+// пространство B, B+1, B+2, ... делится на непрерывные блоки по CHUNK_KEYS ключей.
+// Потоки забирают номера блоков атомарным счетчиком, завершенные блоки
+// периодически записываются в файл контрольной точки, и --resume продолжает
+// поиск, не повторяя завершенные блоки. В кластере (cluster.h) блоки раздает
+// координатор: разбиение рабочего процесса берет их из внешнего источника.
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "secp256k1.h"
+#include "mask.h"
+#include "address.h"
+#include "csprng.h"
+
+// Состояние поиска, сохраняемое вместе с разбиением
+struct CheckpointStats {
+    long long attempts = 0;
+    double seconds = 0;
+    size_t hits = 0;
+    int bestScore = -1;
+    std::vector<size_t> patternsFound;
+    bool complete = false;
+};
+
+class KeyspacePartition {
+public:
+    static constexpr uint32_t FILE_VERSION = 1;
+    // Пакетов обхода размера по умолчанию в одном блоке: 256 * 2048 = 524288 ключей.
+    // Пакеты другого размера (степени двойки до MAX_WALK_BATCH_SIZE) делят блок нацело
+    static constexpr uint64_t CHUNK_BATCHES = 256;
+    static constexpr uint64_t CHUNK_KEYS = CHUNK_BATCHES * WALK_BATCH_SIZE;
+
+    // Описание задачи: при возобновлении должно совпадать с сохраненным
+    std::string spec;
+    // Статистика прошлых запусков (для возобновленного поиска)
+    CheckpointStats previous;
+    // Внешний источник блоков (рабочий процесс кластера): claim берет номера из него,
+    // false - блоков больше не будет; завершенные блоки передаются в onComplete
+    std::function<bool(uint64_t&)> source;
+    std::function<void(uint64_t)> onComplete;
+
+    // Новое разбиение со случайным секретным базовым скаляром
+    static std::shared_ptr<KeyspacePartition> create(const std::string& spec) {
+        auto partition = std::make_shared<KeyspacePartition>();
+        partition->spec = spec;
+        SecureRandom rng;
+        partition->base = rng.nextScalar();
+        return partition;
+    }
+
+    // Разбиение с известным базовым скаляром (у рабочего кластера - ноль: ключи блоков
+    // - смещения от базовой точки координатора)
+    static std::shared_ptr<KeyspacePartition> withBase(const secp256k1::Scalar& base) {
+        auto partition = std::make_shared<KeyspacePartition>();
+        partition->base = base;
+        return partition;
+    }
+
+    const secp256k1::Scalar& baseScalar() const { return base; }
+
+    // Номер следующего незавершенного блока (без блокировок, если нет внешнего источника)
+    bool claim(uint64_t& chunk) {
+        if (source) {
+            return source(chunk);
+        }
+        while (true) {
+            chunk = nextChunk.fetch_add(1);
+            if (!std::binary_search(resumedDone.begin(), resumedDone.end(), chunk)) {
+                return true;
+            }
+        }
+    }
+
+    // Первый ключ блока: B + chunk * CHUNK_KEYS (mod n)
+    secp256k1::Scalar chunkStart(uint64_t chunk) const {
+        return secp256k1::Scalar::add(base, secp256k1::Scalar::fromUint64(chunk * CHUNK_KEYS));
+    }
+
+    // Отметка блока как полностью проверенного
+    void complete(uint64_t chunk) {
+        if (onComplete) {
+            onComplete(chunk);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        completedAbove.insert(chunk);
+        while (!completedAbove.empty() && *completedAbove.begin() == watermark) {
+            completedAbove.erase(completedAbove.begin());
+            watermark++;
+        }
+    }
+
+    // Количество полностью проверенных блоков
+    uint64_t completedChunks() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return watermark + completedAbove.size();
+    }
+
+    // Запись контрольной точки: временный файл с правами только для владельца
+    // (он содержит секретный базовый скаляр) и атомарная замена
+    bool save(const std::string& path, const CheckpointStats& stats, std::string& error) const {
+        std::ostringstream out;
+        out << "# CryptoSpider checkpoint: содержит секрет, из которого выводятся все ключи поиска\n";
+        out << "version " << FILE_VERSION << "\n";
+        out << "spec " << spec << "\n";
+        uint8_t bytes[32];
+        base.toBytes(bytes);
+        out << "base ";
+        for (uint8_t b : bytes) {
+            out << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
+        }
+        out << std::dec << "\n";
+        out << "chunk_keys " << CHUNK_KEYS << "\n";
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            out << "watermark " << watermark << "\n";
+            out << "done";
+            for (uint64_t chunk : completedAbove) {
+                out << " " << chunk;
+            }
+            out << "\n";
+        }
+        out << "attempts " << stats.attempts << "\n";
+        out << std::fixed << std::setprecision(1) << "seconds " << stats.seconds << "\n";
+        out << "hits " << stats.hits << "\n";
+        out << "best_score " << stats.bestScore << "\n";
+        out << "patterns_found";
+        for (size_t index : stats.patternsFound) {
+            out << " " << index;
+        }
+        out << "\n";
+        out << "status " << (stats.complete ? "complete" : "running") << "\n";
+
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            std::error_code ec;
+            std::filesystem::permissions(tempPath, std::filesystem::perms::owner_read |
+                                                   std::filesystem::perms::owner_write,
+                                         std::filesystem::perm_options::replace, ec);
+            file << out.str();
+            if (!file) {
+                error = "не удалось записать контрольную точку: " + tempPath;
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            error = "не удалось записать контрольную точку: " + path;
+            return false;
+        }
+        return true;
+    }
+
+    // Загрузка контрольной точки. Блоки выше watermark, завершенные в прошлых
+    // запусках, пропускаются при выдаче; незавершенные блоки проверяются заново
+    static std::shared_ptr<KeyspacePartition> load(const std::string& path, std::string& error) {
+        std::ifstream in(path);
+        if (!in) {
+            error = "не удалось открыть контрольную точку: " + path;
+            return nullptr;
+        }
+        auto result = std::make_shared<KeyspacePartition>();
+        KeyspacePartition& partition = *result;
+        bool hasBase = false;
+        uint32_t version = 0;
+        uint64_t chunkKeys = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string key;
+            fields >> key;
+            if (key == "version") {
+                fields >> version;
+            } else if (key == "spec") {
+                std::getline(fields >> std::ws, partition.spec);
+            } else if (key == "base") {
+                std::string hex;
+                fields >> hex;
+                uint8_t bytes[32];
+                bool valid = hex.size() == 64 &&
+                             hex.find_first_not_of("0123456789abcdef") == std::string::npos;
+                for (int i = 0; valid && i < 32; i++) {
+                    bytes[i] = static_cast<uint8_t>(hexNibble(hex[i * 2]) << 4 | hexNibble(hex[i * 2 + 1]));
+                }
+                if (valid) {
+                    partition.base = secp256k1::Scalar::fromBytes(bytes);
+                    hasBase = !partition.base.isZero();
+                }
+            } else if (key == "chunk_keys") {
+                fields >> chunkKeys;
+            } else if (key == "watermark") {
+                fields >> partition.watermark;
+            } else if (key == "done") {
+                uint64_t chunk;
+                while (fields >> chunk) partition.resumedDone.push_back(chunk);
+            } else if (key == "attempts") {
+                fields >> partition.previous.attempts;
+            } else if (key == "seconds") {
+                fields >> partition.previous.seconds;
+            } else if (key == "hits") {
+                fields >> partition.previous.hits;
+            } else if (key == "best_score") {
+                fields >> partition.previous.bestScore;
+            } else if (key == "patterns_found") {
+                size_t index;
+                while (fields >> index) partition.previous.patternsFound.push_back(index);
+            } else if (key == "status") {
+                std::string status;
+                fields >> status;
+                partition.previous.complete = status == "complete";
+            }
+        }
+        if (version != FILE_VERSION || !hasBase || chunkKeys != CHUNK_KEYS) {
+            error = "контрольная точка повреждена или от другой версии: " + path;
+            return nullptr;
+        }
+        std::sort(partition.resumedDone.begin(), partition.resumedDone.end());
+        partition.completedAbove.insert(partition.resumedDone.begin(), partition.resumedDone.end());
+        partition.nextChunk.store(partition.watermark);
+        return result;
+    }
+
+private:
+    secp256k1::Scalar base;
+    std::atomic<uint64_t> nextChunk{0};
+
+    // Все блоки ниже watermark завершены, completedAbove - завершенные блоки выше него
+    mutable std::mutex mutex;
+    uint64_t watermark = 0;
+    std::set<uint64_t> completedAbove;
+    // Блоки выше watermark, завершенные в прошлых запусках (только чтение)
+    std::vector<uint64_t> resumedDone;
+};
+
+#endif // PARTITION_H
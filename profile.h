@@ -0,0 +1,238 @@
+// Профилирование горячего цикла (--profile) без внешних инструментов.
+// Пакет обхода делится на стадии (см. ProfileStage); время стадий снимается счетчиком
+// тактов (TSC на x86, иначе монотонные часы в нс) только на каждом PROFILE_SAMPLE_INTERVAL-м
+// пакете потока, а время каждого пакета попадает в HDR-гистограмму потока. Все счетчики
+// потока пишет только он сам, отчет (см. ProfileReporter в metrics.h) суммирует их без блокировок.
+// Границы стадий отмечаются всегда, независимо от --profile: статическими точками USDT
+// (cryptospider:stage_begin / stage_end, если при сборке есть <sys/sdt.h>) или вызовами
+// пустых функций cryptospider_stage_begin / cryptospider_stage_end для uprobe (perf probe).
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROFILE_HAVE_SDT 1
+#endif
+#endif
+
+// Стадии пакета обхода
+enum class ProfileStage : int {
+    Start,      // Новая стартовая точка: CSPRNG и k*G (при рестарте обхода или новом блоке)
+    Points,     // Сложения точек пакета
+    Inverse,    // Перевод пакета в аффинные координаты (общая инверсия)
+    Serialize,  // Симметрии кривой и сериализация публичных ключей
+    Keccak,     // Пакетный Keccak-256: адреса ключей, контрактов, CREATE2
+    Scan,       // Проверка адресов: маска, шаблоны, счет
+    Count
+};
+
+inline constexpr int PROFILE_STAGES = static_cast<int>(ProfileStage::Count);
+
+// Замеряется каждый PROFILE_SAMPLE_INTERVAL-й пакет потока
+inline constexpr uint64_t PROFILE_SAMPLE_INTERVAL = 8;
+
+inline const char* profileStageName(ProfileStage stage) {
+    switch (stage) {
+    case ProfileStage::Start: return "start";
+    case ProfileStage::Points: return "points";
+    case ProfileStage::Inverse: return "inverse";
+    case ProfileStage::Serialize: return "serialize";
+    case ProfileStage::Keccak: return "keccak";
+    case ProfileStage::Scan: return "scan";
+    case ProfileStage::Count: break;
+    }
+    return "unknown";
+}
+
+#if defined(PROFILE_HAVE_SDT)
+#define PROFILE_STAGE_BEGIN(stage) DTRACE_PROBE1(cryptospider, stage_begin, static_cast<int>(stage))
+#define PROFILE_STAGE_END(stage) DTRACE_PROBE1(cryptospider, stage_end, static_cast<int>(stage))
+#elif defined(__GNUC__) || defined(__clang__)
+// Без <sys/sdt.h>: несвертываемые вызовы с номером стадии в первом аргументе,
+// perf probe -x CryptoSpider cryptospider_stage_begin stage=%di (x86-64)
+extern "C" __attribute__((noinline, used)) inline void cryptospider_stage_begin(int stage) {
+    asm volatile("" : : "r"(stage) : "memory");
+}
+extern "C" __attribute__((noinline, used)) inline void cryptospider_stage_end(int stage) {
+    asm volatile("" : : "r"(stage) : "memory");
+}
+#define PROFILE_STAGE_BEGIN(stage) cryptospider_stage_begin(static_cast<int>(stage))
+#define PROFILE_STAGE_END(stage) cryptospider_stage_end(static_cast<int>(stage))
+#else
+#define PROFILE_STAGE_BEGIN(stage) ((void)0)
+#define PROFILE_STAGE_END(stage) ((void)0)
+#endif
+
+// Единицы profileTicks: такты TSC (опорная частота) на x86, наносекунды на остальных
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+inline constexpr bool PROFILE_TICKS_ARE_CYCLES = true;
+inline uint64_t profileTicks() {
+    return __rdtsc();
+}
+#else
+inline constexpr bool PROFILE_TICKS_ARE_CYCLES = false;
+inline uint64_t profileTicks() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+// Процессорное время текущего потока, нс; 0 - платформа не дает его дешево
+inline uint64_t threadCpuNanos() {
+#if defined(__linux__)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+#endif
+    return 0;
+}
+
+// Гистограмма в стиле HDR: каждая октава [2^m, 2^(m+1)) делится на SUB_COUNT равных
+// корзин, поэтому относительная погрешность не больше 1/SUB_COUNT на всем диапазоне
+// uint64 при фиксированных ~8 КБ. Один писатель - свой поток, читатели суммируют
+// корзины без блокировок (см. WorkerStats)
+class HdrHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    static int bucketOf(uint64_t value) {
+        if (value < 2 * SUB_COUNT) {
+            return static_cast<int>(value);
+        }
+        int shift = 63 - std::countl_zero(value) - SUB_BITS;
+        return shift * SUB_COUNT + static_cast<int>(value >> shift);
+    }
+
+    // Середина диапазона корзины
+    static uint64_t bucketValue(int bucket) {
+        if (bucket < 2 * SUB_COUNT) {
+            return static_cast<uint64_t>(bucket);
+        }
+        int shift = bucket / SUB_COUNT - 1;
+        uint64_t lower = static_cast<uint64_t>(bucket - shift * SUB_COUNT) << shift;
+        return lower + ((uint64_t(1) << shift) - 1) / 2;
+    }
+
+    void record(uint64_t value) {
+        std::atomic<uint64_t>& counter = counts[bucketOf(value)];
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void addTo(std::vector<uint64_t>& totals) const {
+        totals.resize(BUCKETS, 0);
+        for (int b = 0; b < BUCKETS; b++) {
+            totals[b] += counts[b].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Квантиль q (0..1) суммы гистограмм; 0, если значений нет
+    static uint64_t percentile(const std::vector<uint64_t>& totals, double q) {
+        uint64_t total = 0;
+        for (uint64_t count : totals) {
+            total += count;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < totals.size(); b++) {
+            seen += totals[b];
+            if (seen >= rank) {
+                return bucketValue(static_cast<int>(b));
+            }
+        }
+        return bucketValue(BUCKETS - 1);
+    }
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS]{};
+};
+
+// Профиль рабочего потока пула, пишет только сам поток
+struct alignas(64) ThreadProfile {
+    // Тики стадий: Start - по всем стартам, остальные - по выборочным пакетам
+    std::atomic<uint64_t> stageTicks[PROFILE_STAGES]{};
+    std::atomic<uint64_t> sampledBatches{0};
+    std::atomic<uint64_t> sampledAddresses{0};
+    // Время выборочных пакетов по часам и по процессорному времени потока:
+    // разница - вытеснение потока (другие процессы, троттлинг квотой cgroup)
+    std::atomic<uint64_t> sampledWallNanos{0};
+    std::atomic<uint64_t> sampledCpuNanos{0};
+    // Время всех пакетов; остальное время потока - простой (ожидание задачи, парковка)
+    std::atomic<uint64_t> busyNanos{0};
+    HdrHistogram batchNanos;
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+// Отметки стадий пакета в рабочем потоке. Метки для внешних профилировщиков ставятся
+// всегда, тики читаются, только пока sampling == true (выборочный пакет или старт)
+class StageTimer {
+public:
+    bool sampling = false;
+    uint64_t batches = 0;  // Пакетов потока: выборка - каждый PROFILE_SAMPLE_INTERVAL-й
+    uint64_t ticks[PROFILE_STAGES] = {};
+
+    // Конец текущей стадии и начало следующей
+    void begin(ProfileStage stage) {
+        uint64_t now = sampling ? profileTicks() : 0;
+        finish(now);
+        PROFILE_STAGE_BEGIN(stage);
+        current = stage;
+        active = true;
+        last = now;
+    }
+
+    void end() {
+        finish(sampling && active ? profileTicks() : 0);
+    }
+
+    // Перенос накопленных тиков в профиль потока
+    void flush(ThreadProfile& profile) {
+        for (int s = 0; s < PROFILE_STAGES; s++) {
+            if (ticks[s] != 0) {
+                ThreadProfile::add(profile.stageTicks[s], ticks[s]);
+                ticks[s] = 0;
+            }
+        }
+    }
+
+private:
+    ProfileStage current = ProfileStage::Start;
+    bool active = false;
+    uint64_t last = 0;
+
+    void finish(uint64_t now) {
+        if (!active) {
+            return;
+        }
+        if (sampling) {
+            ticks[static_cast<int>(current)] += now - last;
+        }
+        PROFILE_STAGE_END(current);
+        active = false;
+    }
+};
+
+#endif // PROFILE_H
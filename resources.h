@@ -0,0 +1,280 @@
+// Ресурсы процесса: сколько CPU ему на самом деле доступно и фоновый режим.
+// Количество потоков по умолчанию берется из квоты CPU cgroup (v1: cpu.cfs_quota_us,
+// v2: cpu.max) и маски допустимых CPU, а не из числа ядер хоста: в контейнере
+// с лимитом 2 CPU лишние потоки только упираются в троттлинг CFS.
+// Фоновый режим понижает приоритет до SCHED_IDLE (или nice 19) и подстраивает
+// число активных потоков по измеренной скорости и статистике троттлинга.
+
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "search.h"
+
+#ifdef __linux__
+// Каталоги cgroup процесса для контроллера cpu, от собственного к корню:
+// вложенные ограничения действуют все, поэтому проверяются все уровни
+inline std::vector<std::string> cgroupCpuDirs(bool& v2) {
+    std::vector<std::string> dirs;
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    std::string v1Path, v2Path;
+    bool hasV2 = false;
+    while (std::getline(in, line)) {
+        // Формат: иерархия:контроллеры:путь
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) continue;
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+        if (controllers.empty()) {
+            v2Path = path;
+            hasV2 = true;
+        }
+        std::stringstream list(controllers);
+        std::string controller;
+        while (std::getline(list, controller, ',')) {
+            if (controller == "cpu") v1Path = path;
+        }
+    }
+
+    std::vector<std::string> roots;
+    std::string relative;
+    if (!v1Path.empty() || !hasV2) {
+        v2 = false;
+        roots = {"/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu"};
+        relative = v1Path;
+    } else {
+        v2 = true;
+        roots = {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"};
+        relative = v2Path;
+    }
+    for (const std::string& root : roots) {
+        std::ifstream probe(root + (v2 ? "/cgroup.controllers" : "/cpu.cfs_period_us"));
+        if (!probe) continue;
+        // С пространством имен cgroup путь из /proc может не существовать в точке монтирования
+        std::string path = relative;
+        while (true) {
+            std::string dir = root + (path == "/" ? "" : path);
+            std::ifstream check(dir + (v2 ? "/cgroup.controllers" : "/cpu.cfs_period_us"));
+            if (check) dirs.push_back(dir);
+            if (path.empty() || path == "/") break;
+            size_t slash = path.rfind('/');
+            path = slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+        }
+        break;
+    }
+    return dirs;
+}
+#endif
+
+// Квота CPU из cgroup в долях CPU (1.5 - полтора CPU); 0 - ограничения нет
+inline double cgroupCpuLimit() {
+    double limit = 0;
+#ifdef __linux__
+    bool v2 = false;
+    for (const std::string& dir : cgroupCpuDirs(v2)) {
+        double quota = -1, period = 0;
+        if (v2) {
+            std::ifstream in(dir + "/cpu.max");
+            std::string max;
+            if (!(in >> max >> period) || max == "max") continue;
+            quota = std::atof(max.c_str());
+        } else {
+            std::ifstream quotaFile(dir + "/cpu.cfs_quota_us");
+            std::ifstream periodFile(dir + "/cpu.cfs_period_us");
+            if (!(quotaFile >> quota) || !(periodFile >> period)) continue;
+        }
+        if (quota > 0 && period > 0) {
+            double cpus = quota / period;
+            limit = limit == 0 ? cpus : std::min(limit, cpus);
+        }
+    }
+#endif
+    return limit;
+}
+
+// Количество периодов CFS, в которых процесс был остановлен квотой (по всем уровням cgroup)
+inline uint64_t cgroupThrottledPeriods() {
+    uint64_t total = 0;
+#ifdef __linux__
+    bool v2 = false;
+    for (const std::string& dir : cgroupCpuDirs(v2)) {
+        std::ifstream in(dir + "/cpu.stat");
+        std::string key;
+        uint64_t value;
+        while (in >> key >> value) {
+            if (key == "nr_throttled") total += value;
+        }
+    }
+#endif
+    return total;
+}
+
+// Количество CPU в маске допустимых CPU процесса
+inline unsigned int affinityCpuCount() {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return static_cast<unsigned int>(CPU_COUNT(&set));
+    }
+#endif
+    return std::thread::hardware_concurrency();
+}
+
+// Доступные процессу CPU: маска допустимых CPU, ограниченная квотой cgroup
+inline double availableCpus() {
+    double cpus = std::max(1u, affinityCpuCount());
+    double limit = cgroupCpuLimit();
+    if (limit > 0) {
+        cpus = std::min(cpus, limit);
+    }
+    return cpus;
+}
+
+// Количество рабочих потоков по умолчанию: квота округляется вверх
+// (1.5 CPU - 2 потока), share - доля доступных CPU (--cpu-share)
+inline unsigned int defaultWorkerCount(double share = 1.0) {
+    return std::max(1u, static_cast<unsigned int>(std::ceil(availableCpus() * share - 1e-9)));
+}
+
+// Низкий приоритет для текущего потока; потоки, созданные после вызова,
+// наследуют его. Linux: SCHED_IDLE (с запасным nice 19), Windows: IDLE_PRIORITY_CLASS
+inline bool enterBackgroundPriority() {
+#ifdef _WIN32
+    return SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS) != 0;
+#else
+#ifdef __linux__
+    sched_param param{};
+    if (sched_setscheduler(0, SCHED_IDLE, &param) == 0) {
+        return true;
+    }
+#endif
+    return setpriority(PRIO_PROCESS, 0, 19) == 0;
+#endif
+}
+
+// Подстройка числа активных потоков пула в фоновом режиме. Раз в INTERVAL_SECONDS
+// измеряет суммарную скорость и запоминает лучшую для каждого числа потоков:
+// - процесс троттлится квотой или скорость заметно ниже прежней при том же числе
+//   потоков (CPU заняты другими задачами, которым SCHED_IDLE уступает) - поток убирается;
+// - последний добавленный поток не дает прироста (соседи по SMT, память) - тоже;
+// - иначе, если при большем числе потоков скорость была выше, еще не измерялась
+//   или давно не проверялась, добавляется один поток, но не больше maxWorkers.
+// Начинает с одного потока
+class AdaptiveWorkers {
+public:
+    static constexpr double INTERVAL_SECONDS = 5;
+    static constexpr double SLOW_RATIO = 0.75;   // Скорость ниже этой доли прежней - CPU заняты
+    static constexpr double GAIN_RATIO = 1.02;   // Минимальный прирост от лишнего потока
+    static constexpr double DECAY = 0.98;        // Старый рекорд текущего уровня постепенно забывается
+    static constexpr int PROBE_INTERVALS = 12;   // Повторная проверка большего числа потоков
+
+    AdaptiveWorkers(SearchPool& pool, unsigned int maxWorkers)
+        : pool(pool), maxWorkers(std::max(1u, std::min(maxWorkers, pool.threadCount()))) {
+        // Начинаем с одного потока и добавляем, пока это дает прирост
+        pool.setActiveLimit(1);
+        thread = std::thread(&AdaptiveWorkers::run, this);
+    }
+
+    ~AdaptiveWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+    }
+
+    AdaptiveWorkers(const AdaptiveWorkers&) = delete;
+    AdaptiveWorkers& operator=(const AdaptiveWorkers&) = delete;
+
+private:
+    SearchPool& pool;
+    unsigned int maxWorkers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+    std::thread thread;
+
+    uint64_t totalAttempts() const {
+        uint64_t total = 0;
+        for (unsigned int i = 0; i < pool.threadCount(); i++) {
+            total += pool.workerStats(i).attempts.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void run() {
+        std::vector<double> levelRate(maxWorkers + 2, 0);
+        int intervalsSinceChange = 0;
+        uint64_t lastAttempts = totalAttempts();
+        uint64_t lastThrottled = cgroupThrottledPeriods();
+        auto lastTime = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!condition.wait_for(lock, std::chrono::duration<double>(INTERVAL_SECONDS),
+                                   [this] { return stopping; })) {
+            uint64_t attempts = totalAttempts();
+            uint64_t throttled = cgroupThrottledPeriods();
+            auto now = std::chrono::steady_clock::now();
+            double rate = (attempts - lastAttempts) / std::chrono::duration<double>(now - lastTime).count();
+            bool wasThrottled = throttled > lastThrottled;
+            lastAttempts = attempts;
+            lastThrottled = throttled;
+            lastTime = now;
+            // Пул простаивает без задач: замер ничего не говорит о нагрузке
+            if (rate <= 0) {
+                continue;
+            }
+
+            unsigned int active = pool.activeLimit();
+            double& best = levelRate[active];
+            bool contended = best > 0 && rate < best * SLOW_RATIO;
+            best = std::max(best * DECAY, rate);
+            intervalsSinceChange++;
+
+            unsigned int next = active;
+            if ((wasThrottled || contended) && active > 1) {
+                next = active - 1;
+            } else if (active > 1 && levelRate[active - 1] > 0 && rate < levelRate[active - 1] * GAIN_RATIO) {
+                next = active - 1;
+            } else if (!wasThrottled && active < maxWorkers &&
+                       (levelRate[active + 1] == 0 || levelRate[active + 1] > rate * GAIN_RATIO ||
+                        intervalsSinceChange >= PROBE_INTERVALS)) {
+                next = active + 1;
+            }
+            if (next != active) {
+                pool.setActiveLimit(next);
+                intervalsSinceChange = 0;
+            }
+        }
+    }
+};
+
+#endif // RESOURCES_H
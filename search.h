@@ -0,0 +1,851 @@
+// Задачи поиска и постоянный пул рабочих потоков.
+// Задача описывает, что искать (маска, набор шаблонов, лучший счет или соль CREATE2) и куда
+// отдавать совпадения; пул держит потоки и их буферы обхода между задачами,
+// поэтому очередь из множества мелких задач не платит за запуск потоков.
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "secp256k1.h"
+#include "mask.h"
+#include "address.h"
+#include "tron.h"
+#include "create2.h"
+#include "partition.h"
+#include "topology.h"
+#include "profile.h"
+
+enum class SearchKind {
+    Mask,      // Одна маска, resultLimit адресов
+    Patterns,  // Набор шаблонов, каждый шаблон - один раз
+    Score,     // Лучший адрес по счету, каждый новый рекорд
+    Tron,      // Маска адреса TRON в base58 (см. tron.h), resultLimit адресов
+    Create2    // Маска адреса контракта CREATE2, перебор соли (см. create2.h), resultLimit адресов
+};
+
+enum class StopReason {
+    Running,
+    Complete,   // Найдено все, что требовалось
+    Timeout,    // Истекло время задачи
+    Cancelled   // Задача отменена
+};
+
+inline const char* stopReasonName(StopReason reason) {
+    switch (reason) {
+    case StopReason::Running: return "running";
+    case StopReason::Complete: return "complete";
+    case StopReason::Timeout: return "timeout";
+    case StopReason::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+// Счетчики рабочего потока пула. Каждый поток пишет только в свою структуру,
+// выровненную по строке кэша (без атомарных read-modify-write и без общих строк
+// между ядрами), отчет метрик читает и суммирует их без блокировок
+struct alignas(64) WorkerStats {
+    static constexpr int LATENCY_BUCKETS = 10;
+    // Верхние границы корзин гистограммы времени пакета, мкс; последняя корзина - больше
+    static constexpr double LATENCY_BOUNDS[LATENCY_BUCKETS - 1] = {
+        500, 1000, 2000, 4000, 8000, 16000, 32000, 64000, 128000};
+
+    std::atomic<uint64_t> attempts{0};    // Проверенные адреса
+    std::atomic<uint64_t> ecOps{0};       // Сложения точек
+    std::atomic<uint64_t> hashes{0};      // Вычисления Keccak-256
+    std::atomic<uint64_t> nearMisses{0};  // Почти совпадения (см. SearchJob::scanBatch)
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> latency[LATENCY_BUCKETS]{};
+    std::atomic<uint64_t> latencyMicros{0};
+
+    // points - вычисленные точки, addresses - проверенные адреса (с симметриями кривой их больше),
+    // hashCount - вычисления Keccak (с адресами контрактов их больше, чем адресов)
+    void recordBatch(uint64_t points, uint64_t addresses, uint64_t hashCount, uint64_t nearMissCount,
+                     double micros) {
+        add(attempts, addresses);
+        add(ecOps, points);
+        add(hashes, hashCount);
+        add(nearMisses, nearMissCount);
+        add(batches, 1);
+        int bucket = 0;
+        while (bucket < LATENCY_BUCKETS - 1 && micros > LATENCY_BOUNDS[bucket]) {
+            bucket++;
+        }
+        add(latency[bucket], 1);
+        add(latencyMicros, static_cast<uint64_t>(micros));
+    }
+
+private:
+    // Единственный писатель: обычные загрузка и запись вместо lock-инструкции
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+// Совпадение, найденное задачей
+struct SearchHit {
+    secp256k1::Scalar key;    // Приватный ключ, в режиме разделенного ключа - смещение k
+    AddressBytes addressBytes;
+    size_t patternIndex = 0;  // Только для SearchKind::Patterns
+    int score = 0;            // Только для SearchKind::Score
+    bool checksum = false;    // Показывать адрес с checksum EIP-55
+    Salt salt{};              // Только для SearchKind::Create2 (key не используется)
+    uint64_t nonce = 0;       // addressBytes - адрес контракта ключа с этим nonce (SearchJob::contractNonces)
+    size_t symmetry = 0;      // Симметрия точки смещения (SearchJob::baseSymmetries, см. KeyWalker::symmetryAt)
+};
+
+struct SearchJob {
+    // Параметры задачи, задаются до SearchPool::submit
+    std::string id;
+    SearchKind kind = SearchKind::Mask;
+    CompiledMask mask;
+    TronMask tronMask;
+    PatternSet patterns;
+    ScoreMode scoreMode = ScoreMode::LeadingZeros;
+    int scoreTarget = 40;
+    size_t resultLimit = 1;       // Mask: количество адресов; Patterns: лимит совпадений (0 - все шаблоны)
+    double timeoutSeconds = 0;    // 0 - без ограничения
+    // Детерминированное разбиение ключей (контрольные точки); nullptr - случайные стартовые точки
+    std::shared_ptr<KeyspacePartition> partition;
+    // Разделенный ключ: публичный ключ клиента Q, ищутся смещения k для адреса Q + k*G.
+    // Бесконечно удаленная точка - обычный режим с полным приватным ключом
+    secp256k1::AffinePoint basePoint{{}, {}, true};
+    // Симметрии кривой и с базовой точкой (рабочий кластера: скаляр точки знает координатор).
+    // Результат - смещение k и номер симметрии (SearchHit::symmetry)
+    bool baseSymmetries = false;
+    // CREATE2: деплоер и хеш init-кода, только для SearchKind::Create2
+    Create2Params create2;
+    // Адреса контрактов CREATE, созданных ключом с nonce 0..contractNonces-1, вместо адреса
+    // самого ключа (см. KeyWalker::setContractNonces); 0 - адрес ключа
+    size_t contractNonces = 0;
+
+    // onHit вызывается под mutex задачи, onFinish - один раз после остановки всех потоков
+    std::function<void(const SearchJob&, const SearchHit&)> onHit;
+    std::function<void(const SearchJob&)> onFinish;
+
+    // Состояние выполнения
+    std::atomic<bool> stopped{false};
+    std::atomic<int> bestScore{-1};
+    StopReason reason = StopReason::Running;  // Защищено mutex
+    size_t hits = 0;                          // Защищено mutex
+    std::vector<bool> patternSatisfied;       // Защищено mutex
+    size_t patternsRemaining = 0;             // Защищено mutex
+    std::chrono::steady_clock::time_point startTime;  // Действительно, когда running == true
+    std::atomic<bool> running{false};
+    std::chrono::steady_clock::time_point deadline;
+    double durationSeconds = 0;  // Время выполнения, известно к вызову onFinish
+    std::mutex mutex;
+
+    // Остановка задачи; первая причина остановки сохраняется
+    void stop(StopReason stopReason) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopLocked(stopReason);
+    }
+
+    // Время с начала выполнения (0, пока задача ждет в очереди)
+    double elapsedSeconds() const {
+        if (!running.load()) {
+            return 0;
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    bool splitKey() const { return !basePoint.infinity; }
+
+    // Публичный ключ клиента 0x04 + X + Y для независимой проверки (пустой в обычном режиме)
+    std::vector<uint8_t> basePublicKey() const {
+        if (!splitKey()) {
+            return {};
+        }
+        std::vector<uint8_t> publicKey(65);
+        publicKey[0] = 0x04;
+        basePoint.serialize(publicKey.data() + 1);
+        return publicKey;
+    }
+
+    // Проверенные задачей адреса: сумма счетчиков потоков
+    long long attemptCount() const {
+        if (!running.load()) {
+            return 0;
+        }
+        long long total = 0;
+        for (unsigned int i = 0; i < threadSlots; i++) {
+            total += threadAttempts[i].value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Вероятность того, что один случайный адрес - результат задачи
+    double hitProbability() {
+        switch (kind) {
+        case SearchKind::Mask:
+        case SearchKind::Create2:
+            return mask.probability();
+        case SearchKind::Patterns: {
+            std::lock_guard<std::mutex> lock(mutex);
+            double p = 0;
+            for (size_t i = 0; i < patterns.size(); i++) {
+                if (i >= patternSatisfied.size() || !patternSatisfied[i]) {
+                    p += patterns.masks[i].probability();
+                }
+            }
+            return p;
+        }
+        case SearchKind::Score:
+            return scoreProbability(scoreMode, scoreTarget);
+        case SearchKind::Tron:
+            return tronMask.probability();
+        }
+        return 0;
+    }
+
+    // Ожидаемая доля почти совпадений (0, если задача их не считает)
+    double nearMissProbability() const {
+        switch (kind) {
+        case SearchKind::Mask:
+        case SearchKind::Create2:
+            return trackNearMiss ? nearMask.probability() : 0;
+        case SearchKind::Score:
+            return scoreTarget > 1 ? scoreProbability(scoreMode, scoreTarget - 1) : 0;
+        case SearchKind::Patterns:
+        case SearchKind::Tron:
+            return 0;
+        }
+        return 0;
+    }
+
+    // Индекс шаблонов для узла NUMA node (node < 0 - общий). Копию создает первый
+    // поток узла: память выделяется и заполняется им, поэтому остается на его узле
+    const PatternSet& patternsForNode(int node) {
+        if (node < 0 || kind != SearchKind::Patterns) {
+            return patterns;
+        }
+        std::lock_guard<std::mutex> lock(nodeMutex);
+        auto& copy = nodePatterns[node];
+        if (!copy) {
+            copy = std::make_unique<PatternSet>(patterns);
+        }
+        return *copy;
+    }
+
+    // Ожидание завершения задачи (после onFinish)
+    void wait() {
+        std::unique_lock<std::mutex> lock(finishMutex);
+        finishedCondition.wait(lock, [this] { return finished; });
+    }
+
+    // Проверка пакета адресов обхода; для масок цикл специализирован под форму маски.
+    // Возвращает количество почти совпадений: для маски - совпадения без последнего
+    // заданного символа, для счета - адреса со счетом не ниже scoreTarget - 1
+    size_t scanBatch(KeyWalker& walker) {
+        return scanBatch(walker, patterns);
+    }
+
+    // То же с копией индекса шаблонов для узла NUMA потока (см. patternsForNode)
+    size_t scanBatch(KeyWalker& walker, const PatternSet& patternSet) {
+        size_t nearMisses = 0;
+        switch (kind) {
+        case SearchKind::Patterns:
+            for (size_t i = 0; i < walker.addressCount(); i++) {
+                const uint8_t* address = walker.address(i);
+                patternSet.forEachMatch(address, [&](size_t patternIndex) {
+                    reportPatternHit(patternIndex, hitAt(walker, i));
+                });
+            }
+            break;
+        case SearchKind::Score:
+            // Под mutex идут только новые рекорды
+            for (size_t i = 0; i < walker.addressCount(); i++) {
+                const uint8_t* address = walker.address(i);
+                int score = scoreAddress(scoreMode, address);
+                nearMisses += score >= scoreTarget - 1;
+                if (score > bestScore.load(std::memory_order_relaxed)) {
+                    reportScore(score, hitAt(walker, i));
+                }
+            }
+            break;
+        case SearchKind::Mask:
+            withMaskMatcher(mask, [&](auto&& matches) {
+                nearMisses = walker.filtered() ? scanFiltered(walker, matches) : scanBitmap(walker, matches);
+            });
+            break;
+        case SearchKind::Tron:
+            nearMisses = scanBitmap(walker, [this](const uint8_t* address) {
+                return tronMask.matches(address);
+            });
+            break;
+        case SearchKind::Create2:
+            break;
+        }
+        return nearMisses;
+    }
+
+    // Пакет адресов CREATE2 (см. SaltWalker): только маска
+    size_t scanBatch(SaltWalker& walker) {
+        size_t nearMisses = 0;
+        withMaskMatcher(mask, [&](auto&& matches) {
+            nearMisses = walker.filtered() ? scanFiltered(walker, matches) : scanBitmap(walker, matches);
+        });
+        return nearMisses;
+    }
+
+    // Проверка одного адреса с известным ключом по правилам задачи (совпадение, присланное
+    // рабочим процессом кластера). false, если адрес не подходит под задачу; подходящий
+    // отдается через onHit как обычно (повторы шаблонов и не рекорды счета отбрасываются).
+    // nonce - для адреса контракта ключа (contractNonces > 0)
+    bool checkAddress(const secp256k1::Scalar& key, const uint8_t* address, uint64_t nonce = 0) {
+        bool matched = false;
+        switch (kind) {
+        case SearchKind::Patterns:
+            patterns.forEachMatch(address, [&](size_t patternIndex) {
+                reportPatternHit(patternIndex, makeHit(key, address, nonce));
+                matched = true;
+            });
+            break;
+        case SearchKind::Score: {
+            // Счет есть у любого адреса: отдается только новый рекорд
+            int score = scoreAddress(scoreMode, address);
+            if (score > bestScore.load()) {
+                reportScore(score, makeHit(key, address, nonce));
+            }
+            matched = true;
+            break;
+        }
+        case SearchKind::Mask:
+            matched = mask.matches(address);
+            break;
+        case SearchKind::Tron:
+            matched = tronMask.matches(address);
+            break;
+        case SearchKind::Create2:
+            // Результат CREATE2 - соль, а не ключ: такие задачи по ключам не проверяются
+            break;
+        }
+        if (matched && (kind == SearchKind::Mask || kind == SearchKind::Tron)) {
+            reportMaskHit(makeHit(key, address, nonce));
+        }
+        return matched;
+    }
+
+private:
+    friend class SearchPool;
+    friend class ClusterCoordinator;
+
+    // Счетчики попыток по потокам пула, каждый в своей строке кэша
+    struct alignas(64) PaddedCounter {
+        std::atomic<long long> value{0};
+    };
+    std::unique_ptr<PaddedCounter[]> threadAttempts;
+    unsigned int threadSlots = 0;
+
+    CompiledMask nearMask;
+    bool trackNearMiss = false;
+
+    // Фильтр маски в Keccak (см. Keccak::AddressFilter) для SearchKind::Mask и Create2
+    Keccak::AddressFilter addressFilter;
+    bool filterAddresses = false;
+
+    std::mutex nodeMutex;
+    std::map<int, std::unique_ptr<PatternSet>> nodePatterns;
+
+    // Состояние очереди пула, защищено мьютексом пула
+    bool started = false;
+    bool dequeued = false;
+    bool finishing = false;
+    unsigned int activeWorkers = 0;
+
+    std::mutex finishMutex;
+    std::condition_variable finishedCondition;
+    bool finished = false;
+
+    // Сначала весь пакет проверяется без ветвлений в битовую карту,
+    // затем ключи (соли) восстанавливаются только для установленных битов
+    template <typename Walker, typename Matches>
+    size_t scanBitmap(Walker& walker, Matches&& matches) {
+        size_t nearMisses = 0;
+        uint64_t* bitmap = walker.matchBitmap();
+        size_t words = walker.addressCount() / 64;
+        for (size_t w = 0; w < words; w++) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j++) {
+                const uint8_t* address = walker.address(w * 64 + j);
+                if (trackNearMiss) {
+                    nearMisses += nearMask.matchesLower(address);
+                }
+                bits |= static_cast<uint64_t>(matches(address)) << j;
+            }
+            bitmap[w] = bits;
+        }
+        for (size_t w = 0; w < words && !stopped.load(std::memory_order_relaxed); w++) {
+            for (uint64_t bits = bitmap[w]; bits != 0; bits &= bits - 1) {
+                size_t i = w * 64 + static_cast<size_t>(std::countr_zero(bits));
+                reportMaskHit(hitAt(walker, i));
+            }
+        }
+        return nearMisses;
+    }
+
+    // Пакет, уже отфильтрованный в Keccak (см. KeyWalker::setAddressFilter): адреса есть
+    // только у установленных битов карты, полная маска с регистром проверяется для них
+    template <typename Walker, typename Matches>
+    size_t scanFiltered(Walker& walker, Matches&& matches) {
+        size_t passed = 0;
+        const uint64_t* bitmap = walker.matchBitmap();
+        size_t words = walker.addressCount() / 64;
+        for (size_t w = 0; w < words; w++) {
+            passed += static_cast<size_t>(std::popcount(bitmap[w]));
+            for (uint64_t bits = bitmap[w]; bits != 0 && !stopped.load(std::memory_order_relaxed); bits &= bits - 1) {
+                size_t i = w * 64 + static_cast<size_t>(std::countr_zero(bits));
+                if (matches(walker.address(i))) {
+                    reportMaskHit(hitAt(walker, i));
+                }
+            }
+        }
+        return trackNearMiss ? passed : 0;
+    }
+
+    SearchHit hitAt(const KeyWalker& walker, size_t i) const {
+        if (baseSymmetries) {
+            SearchHit hit = makeHit(walker.offsetAt(i), walker.address(i), walker.nonceAt(i));
+            hit.symmetry = walker.symmetryAt(i);
+            return hit;
+        }
+        return makeHit(walker.keyAt(i), walker.address(i), walker.nonceAt(i));
+    }
+
+    SearchHit hitAt(const SaltWalker& walker, size_t i) const {
+        SearchHit hit = makeHit(secp256k1::Scalar(), walker.address(i));
+        hit.salt = walker.saltAt(i);
+        return hit;
+    }
+
+    void stopLocked(StopReason stopReason) {
+        if (reason == StopReason::Running) {
+            reason = stopReason;
+        }
+        stopped.store(true);
+    }
+
+    void start(unsigned int threads) {
+        threadAttempts = std::make_unique<PaddedCounter[]>(threads);
+        threadSlots = threads;
+        // Почти совпадения имеют смысл, пока в маске остается хотя бы один символ
+        if ((kind == SearchKind::Mask || kind == SearchKind::Create2) && mask.fixedNibbles() >= 2) {
+            nearMask = mask.nearMiss();
+            trackNearMiss = true;
+        }
+        // Keccak отсеивает адреса по маске без регистра, а при подсчете почти совпадений -
+        // по их более широкой маске: прошедшие фильтр и есть почти совпадения
+        if (kind == SearchKind::Mask || kind == SearchKind::Create2) {
+            const CompiledMask& filterMask = trackNearMiss ? nearMask : mask;
+            addressFilter = Keccak::addressFilter(filterMask.value, filterMask.care);
+            filterAddresses = true;
+        }
+        startTime = std::chrono::steady_clock::now();
+        deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(timeoutSeconds));
+        // Найденные до возобновления шаблоны могут быть отмечены заранее
+        if (kind == SearchKind::Patterns) {
+            patternSatisfied.resize(patterns.size(), false);
+            patternsRemaining = std::count(patternSatisfied.begin(), patternSatisfied.end(), false);
+        }
+        if ((kind == SearchKind::Patterns && patternsRemaining == 0) ||
+            (kind != SearchKind::Patterns && kind != SearchKind::Score && hits >= resultLimit)) {
+            stopLocked(StopReason::Complete);
+        }
+        running.store(true);
+    }
+
+    void countAttempts(unsigned int thread, long long count) {
+        std::atomic<long long>& counter = threadAttempts[thread].value;
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    void finish() {
+        durationSeconds = elapsedSeconds();
+        if (onFinish) {
+            onFinish(*this);
+        }
+        std::lock_guard<std::mutex> lock(finishMutex);
+        finished = true;
+        finishedCondition.notify_all();
+    }
+
+    SearchHit makeHit(const secp256k1::Scalar& key, const uint8_t* address, uint64_t nonce = 0) const {
+        SearchHit hit;
+        hit.key = key;
+        std::copy(address, address + 20, hit.addressBytes.begin());
+        hit.nonce = nonce;
+        return hit;
+    }
+
+    void reportMaskHit(SearchHit hit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped.load()) {
+            return;
+        }
+        hit.checksum = (kind == SearchKind::Mask || kind == SearchKind::Create2) && mask.upperCount > 0;
+        hits++;
+        if (onHit) onHit(*this, hit);
+        if (hits >= resultLimit) {
+            stopLocked(StopReason::Complete);
+        }
+    }
+
+    // Каждый шаблон выводится один раз, задача останавливается, когда найдены
+    // все шаблоны или достигнут лимит совпадений
+    void reportPatternHit(size_t patternIndex, SearchHit hit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped.load() || patternSatisfied[patternIndex]) {
+            return;
+        }
+        patternSatisfied[patternIndex] = true;
+        patternsRemaining--;
+        hits++;
+        hit.patternIndex = patternIndex;
+        hit.checksum = patterns.masks[patternIndex].upperCount > 0;
+        if (onHit) onHit(*this, hit);
+        if (patternsRemaining == 0 || (resultLimit != 0 && hits >= resultLimit)) {
+            stopLocked(StopReason::Complete);
+        }
+    }
+
+    // Новый лучший адрес; задача останавливается, когда достигнут целевой счет
+    void reportScore(int score, SearchHit hit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped.load() || score <= bestScore.load()) {
+            return;
+        }
+        bestScore.store(score);
+        hits++;
+        hit.score = score;
+        hit.checksum = true;
+        if (onHit) onHit(*this, hit);
+        if (score >= scoreTarget) {
+            stopLocked(StopReason::Complete);
+        }
+    }
+};
+
+// Постоянный пул потоков: задачи выполняются по очереди, каждую задачу
+// обрабатывают все потоки пула. Буферы обхода живут в потоках между задачами.
+// С планом размещения (см. topology.h) поток i закрепляется за placement[i].cpu,
+// а на нескольких узлах NUMA использует копии таблицы G и индекса шаблонов своего узла.
+// batchSize - точек в пакете обхода (см. chooseWalkBatchSize)
+class SearchPool {
+public:
+    explicit SearchPool(unsigned int numThreads, std::vector<ThreadPlacement> placement = {},
+                        int nodeCount = 1, size_t batchSize = WALK_BATCH_SIZE)
+        : stats(std::make_unique<WorkerStats[]>(numThreads)),
+          profiles(std::make_unique<ThreadProfile[]>(numThreads)),
+          placement(std::move(placement)), nodeCount(nodeCount), batchSize(batchSize),
+          activeLimitValue(numThreads) {
+        for (unsigned int i = 0; i < numThreads; i++) {
+            threads.emplace_back(&SearchPool::workerThread, this, i);
+        }
+    }
+
+    ~SearchPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shuttingDown = true;
+        }
+        condition.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    SearchPool(const SearchPool&) = delete;
+    SearchPool& operator=(const SearchPool&) = delete;
+
+    unsigned int threadCount() const { return static_cast<unsigned int>(threads.size()); }
+
+    const WorkerStats& workerStats(unsigned int thread) const { return stats[thread]; }
+
+    // Профилирование стадий (--profile, см. profile.h): включается один раз, до или во время работы
+    void enableProfiling() { profiling.store(true); }
+
+    bool profilingEnabled() const { return profiling.load(); }
+
+    const ThreadProfile& threadProfile(unsigned int thread) const { return profiles[thread]; }
+
+    // Число активных потоков: потоки с номером >= limit заканчивают текущий пакет
+    // (в режиме разбиения - блок) и ждут, пока лимит не поднимется. Не меньше 1
+    unsigned int activeLimit() const { return activeLimitValue.load(); }
+
+    void setActiveLimit(unsigned int limit) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeLimitValue.store(std::clamp(limit, 1u, threadCount()));
+        }
+        condition.notify_all();
+    }
+
+    // Выполняемая задача (nullptr, если очередь пуста)
+    std::shared_ptr<SearchJob> currentJob() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty() || !queue.front()->started) {
+            return nullptr;
+        }
+        return queue.front();
+    }
+
+    // Постановка задачи в очередь
+    void submit(std::shared_ptr<SearchJob> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(job));
+        }
+        condition.notify_all();
+    }
+
+private:
+    std::unique_ptr<WorkerStats[]> stats;
+    std::unique_ptr<ThreadProfile[]> profiles;
+    std::atomic<bool> profiling{false};
+    std::vector<ThreadPlacement> placement;
+    int nodeCount;
+    size_t batchSize;
+    std::atomic<unsigned int> activeLimitValue;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::shared_ptr<SearchJob>> queue;
+    bool shuttingDown = false;
+
+    // Снятие остановленной задачи с очереди; последний вышедший из нее поток
+    // вызывает onFinish. Вызывается под мьютексом пула
+    void retire(const std::shared_ptr<SearchJob>& job, std::unique_lock<std::mutex>& lock) {
+        if (!job->dequeued) {
+            queue.pop_front();
+            job->dequeued = true;
+        }
+        if (job->activeWorkers == 0 && !job->finishing) {
+            job->finishing = true;
+            lock.unlock();
+            job->finish();
+            lock.lock();
+        }
+    }
+
+    // Функция рабочего потока: берет задачу из начала очереди и обходит ключи,
+    // пока задача не остановлена
+    void workerThread(unsigned int threadId) {
+        // Закрепление за CPU до выделения буферов: они попадут на узел потока
+        int node = -1;
+        if (threadId < placement.size() && placement[threadId].cpu >= 0) {
+            pinCurrentThread(placement[threadId].cpu);
+            if (nodeCount > 1) {
+                node = placement[threadId].node;
+                secp256k1::useNodeLocalGeneratorTable(node);
+            }
+        }
+
+        // Свой криптостойкий генератор для каждого потока
+        SecureRandom rng;
+        KeyWalker walker(batchSize);
+        SaltWalker saltWalker(batchSize);
+        StageTimer timer;
+        walker.setStageTimer(&timer);
+        saltWalker.setStageTimer(&timer);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this, threadId] {
+                return shuttingDown || (!queue.empty() && !parked(threadId));
+            });
+            if (shuttingDown) {
+                return;
+            }
+            std::shared_ptr<SearchJob> job = queue.front();
+            if (!job->started) {
+                job->started = true;
+                job->start(threadCount());
+            }
+            if (job->stopped.load()) {
+                retire(job, lock);
+                continue;
+            }
+            job->activeWorkers++;
+            lock.unlock();
+
+            if (job->kind == SearchKind::Create2) {
+                runSaltJob(*job, saltWalker, rng, threadId);
+            } else {
+                runJob(*job, walker, rng, threadId, node);
+            }
+
+            lock.lock();
+            job->activeWorkers--;
+            // Поток мог выйти из незавершенной задачи из-за лимита активных потоков
+            if (job->stopped.load()) {
+                retire(job, lock);
+            }
+        }
+    }
+
+    bool parked(unsigned int threadId) const {
+        return threadId >= activeLimitValue.load(std::memory_order_relaxed);
+    }
+
+    // Инкрементальный обход от случайной стартовой точки (см. KeyWalker)
+    void runJob(SearchJob& job, KeyWalker& walker, SecureRandom& rng, unsigned int threadId, int node) {
+        const PatternSet& patternSet = job.patternsForNode(node);
+        walker.setBasePoint(job.basePoint, job.baseSymmetries);
+        walker.setContractNonces(job.contractNonces);
+        walker.setAddressFilter(job.filterAddresses ? &job.addressFilter : nullptr);
+        if (job.partition) {
+            runPartitionedJob(job, walker, patternSet, threadId);
+            return;
+        }
+        bool needRestart = true;
+        while (!job.stopped.load() && !parked(threadId)) {
+            if (needRestart) {
+                // Случайная стартовая точка: k в [1, n-1], P = k*G
+                timedStart(walker, threadId, [&] { walker.start(rng.nextScalar()); });
+                needRestart = false;
+            }
+
+            // Если обход прошел через бесконечно удаленную точку,
+            // начинаем с новой случайной точки
+            if (!runBatch(job, walker, patternSet, threadId)) {
+                needRestart = true;
+            }
+        }
+    }
+
+    // Перебор солей CREATE2 от случайной соли (см. SaltWalker)
+    void runSaltJob(SearchJob& job, SaltWalker& walker, SecureRandom& rng, unsigned int threadId) {
+        walker.setParams(job.create2);
+        walker.setAddressFilter(job.filterAddresses ? &job.addressFilter : nullptr);
+        bool needRestart = true;
+        while (!job.stopped.load() && !parked(threadId)) {
+            if (needRestart) {
+                timedStart(walker, threadId, [&] { walker.start(rng); });
+                needRestart = false;
+            }
+            // Набор шаблонов пакету солей не нужен (см. SearchJob::scanBatch)
+            if (!runBatch(job, walker, job.patterns, threadId)) {
+                needRestart = true;
+            }
+        }
+    }
+
+    // Обход по блокам разбиения: поток забирает блок, проверяет все его пакеты
+    // и отмечает блок завершенным. Блок, прерванный остановкой задачи, не отмечается
+    // и при возобновлении будет проверен заново
+    void runPartitionedJob(SearchJob& job, KeyWalker& walker, const PatternSet& patternSet,
+                           unsigned int threadId) {
+        KeyspacePartition& partition = *job.partition;
+        // Размер пакета - степень двойки, блок делится на пакеты нацело
+        const uint64_t chunkBatches = KeyspacePartition::CHUNK_KEYS / walker.batchSize();
+        while (!job.stopped.load() && !parked(threadId)) {
+            uint64_t chunk;
+            if (!partition.claim(chunk)) {
+                break;
+            }
+            timedStart(walker, threadId, [&] { walker.start(partition.chunkStart(chunk)); });
+            uint64_t batch = 0;
+            for (; batch < chunkBatches && !job.stopped.load(); batch++) {
+                // Бесконечно удаленная точка внутри блока (k+i == n) при случайном
+                // базовом скаляре практически невозможна; такой блок пропускается
+                if (!runBatch(job, walker, patternSet, threadId)) {
+                    batch = chunkBatches;
+                    break;
+                }
+            }
+            // После остановки пакет мог быть проверен не до конца
+            if (batch == chunkBatches && !job.stopped.load()) {
+                partition.complete(chunk);
+            }
+        }
+    }
+
+    // Новая стартовая точка обхода - стадия Start; при профилировании ее время
+    // учитывается всегда: старты редки, а по выборке их почти не видно
+    template <typename Walker, typename Start>
+    void timedStart(Walker& walker, unsigned int threadId, Start&& start) {
+        StageTimer& timer = *walker.stageTimer();
+        timer.sampling = profiling.load(std::memory_order_relaxed);
+        timer.begin(ProfileStage::Start);
+        start();
+        timer.end();
+        if (timer.sampling) {
+            timer.flush(profiles[threadId]);
+            timer.sampling = false;
+        }
+    }
+
+    // Один пакет обхода: вычисление, проверка и учет в счетчиках потока.
+    // false, если пакет непригоден (см. KeyWalker::computeBatch, SaltWalker::computeBatch)
+    template <typename Walker>
+    bool runBatch(SearchJob& job, Walker& walker, const PatternSet& patternSet, unsigned int threadId) {
+        StageTimer& timer = *walker.stageTimer();
+        bool profile = profiling.load(std::memory_order_relaxed);
+        timer.sampling = profile && ++timer.batches % PROFILE_SAMPLE_INTERVAL == 0;
+        uint64_t cpuStart = timer.sampling ? threadCpuNanos() : 0;
+        auto batchStart = std::chrono::steady_clock::now();
+        if (!walker.computeBatch()) {
+            timer.end();
+            return false;
+        }
+        timer.begin(ProfileStage::Scan);
+        size_t nearMisses;
+        if constexpr (std::is_same_v<Walker, SaltWalker>) {
+            nearMisses = job.scanBatch(walker);
+        } else {
+            nearMisses = job.scanBatch(walker, patternSet);
+        }
+        walker.advance();
+        timer.end();
+
+        // Соли CREATE2 не требуют сложений точек
+        uint64_t points = std::is_same_v<Walker, SaltWalker> ? 0 : walker.batchSize();
+        auto now = std::chrono::steady_clock::now();
+        if (profile) {
+            recordProfile(threadId, timer, walker.addressCount(), cpuStart,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(now - batchStart).count());
+        }
+        job.countAttempts(threadId, static_cast<long long>(walker.addressCount()));
+        stats[threadId].recordBatch(points, walker.addressCount(), walker.hashCount(), nearMisses,
+                                    std::chrono::duration<double, std::micro>(now - batchStart).count());
+        if (job.timeoutSeconds > 0 && now >= job.deadline) {
+            job.stop(StopReason::Timeout);
+        }
+        return true;
+    }
+
+    void recordProfile(unsigned int threadId, StageTimer& timer, uint64_t addresses, uint64_t cpuStart,
+                       uint64_t nanos) {
+        ThreadProfile& profile = profiles[threadId];
+        profile.batchNanos.record(nanos);
+        ThreadProfile::add(profile.busyNanos, nanos);
+        if (timer.sampling) {
+            timer.flush(profile);
+            timer.sampling = false;
+            ThreadProfile::add(profile.sampledBatches, 1);
+            ThreadProfile::add(profile.sampledAddresses, addresses);
+            ThreadProfile::add(profile.sampledWallNanos, nanos);
+            if (cpuStart != 0) {
+                ThreadProfile::add(profile.sampledCpuNanos, threadCpuNanos() - cpuStart);
+            }
+        }
+    }
+};
+
+#endif // SEARCH_H
@@ -0,0 +1,819 @@
+// Специализированная арифметика кривой secp256k1 для горячего цикла
+// Поле: 4 лимба по 64 бита, быстрая редукция по модулю p = 2^256 - 0x1000003D1
+// Группа: якобиевы координаты, смешанное сложение, пакетный перевод в аффинные;
+// умножение секретного скаляра - полными формулами без ветвлений (см. ProjectivePoint)
+
+#ifndef SECP256K1_H
+#define SECP256K1_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "bytes.h"
+#include "cpudispatch.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace secp256k1 {
+
+// 64x64 -> 128 бит: младшая половина возвращается, старшая пишется в hi
+inline uint64_t mulWide(uint64_t a, uint64_t b, uint64_t& hi) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _umul128(a, b, &hi);
+#else
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    hi = static_cast<uint64_t>(r >> 64);
+    return static_cast<uint64_t>(r);
+#endif
+}
+
+// Сложение с переносом: carry на входе и выходе равен 0 или 1
+inline uint64_t addCarry(uint64_t a, uint64_t b, uint64_t& carry) {
+    uint64_t s = a + carry;
+    uint64_t c = s < carry;
+    s += b;
+    c += s < b;
+    carry = c;
+    return s;
+}
+
+// Вычитание с заемом: borrow на входе и выходе равен 0 или 1
+inline uint64_t subBorrow(uint64_t a, uint64_t b, uint64_t& borrow) {
+    uint64_t d = a - b;
+    uint64_t c = a < b;
+    uint64_t r = d - borrow;
+    c += d < borrow;
+    borrow = c;
+    return r;
+}
+
+// Все единицы, если a == b, иначе 0 - без ветвлений (выбор по секретному индексу)
+inline uint64_t equalMask(uint64_t a, uint64_t b) {
+    uint64_t x = a ^ b;
+    return ((x | (0 - x)) >> 63) - 1;
+}
+
+// Элемент поля GF(p), всегда хранится полностью редуцированным (< p)
+struct FieldElement {
+    uint64_t n[4];  // little-endian порядок лимбов
+
+    // 2^256 - p
+    static constexpr uint64_t C = 0x1000003D1ULL;
+
+    static constexpr FieldElement zero() { return {{0, 0, 0, 0}}; }
+    static constexpr FieldElement one() { return {{1, 0, 0, 0}}; }
+
+    bool isZero() const {
+        return (n[0] | n[1] | n[2] | n[3]) == 0;
+    }
+
+    bool operator==(const FieldElement& o) const {
+        return ((n[0] ^ o.n[0]) | (n[1] ^ o.n[1]) | (n[2] ^ o.n[2]) | (n[3] ^ o.n[3])) == 0;
+    }
+
+    // Загрузка 32 байт big-endian (значения >= p редуцируются)
+    static FieldElement fromBytes(const uint8_t* in) {
+        FieldElement r;
+        for (int i = 0; i < 4; i++) {
+            r.n[i] = loadBE64(in + 24 - 8 * i);
+        }
+        r.normalize(0);
+        return r;
+    }
+
+    // Сериализация в 32 байта big-endian
+    void toBytes(uint8_t* out) const {
+        for (int i = 0; i < 4; i++) {
+            storeBE64(out + 24 - 8 * i, n[i]);
+        }
+    }
+
+    // Приводит значение n + carry * 2^256 к диапазону [0, p)
+    void normalize(uint64_t carry) {
+        // r >= p тогда и только тогда, когда r + C переполняет 256 бит
+        uint64_t c = 0;
+        uint64_t t[4];
+        t[0] = addCarry(n[0], C, c);
+        t[1] = addCarry(n[1], 0, c);
+        t[2] = addCarry(n[2], 0, c);
+        t[3] = addCarry(n[3], 0, c);
+        // Выбор маской, а не ветвлением: время не зависит от значения
+        uint64_t mask = 0 - (c | carry);
+        for (int i = 0; i < 4; i++) {
+            n[i] = (t[i] & mask) | (n[i] & ~mask);
+        }
+    }
+
+    // *this = mask ? a : *this, mask - 0 или все единицы
+    void conditionalMove(const FieldElement& a, uint64_t mask) {
+        for (int i = 0; i < 4; i++) {
+            n[i] = (a.n[i] & mask) | (n[i] & ~mask);
+        }
+    }
+
+    static FieldElement add(const FieldElement& a, const FieldElement& b) {
+        FieldElement r;
+        uint64_t c = 0;
+        for (int i = 0; i < 4; i++) {
+            r.n[i] = addCarry(a.n[i], b.n[i], c);
+        }
+        r.normalize(c);
+        return r;
+    }
+
+    static FieldElement sub(const FieldElement& a, const FieldElement& b) {
+        FieldElement r;
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; i++) {
+            r.n[i] = subBorrow(a.n[i], b.n[i], borrow);
+        }
+        // При заеме r + p = r - C (mod 2^256); вычитается C или 0, без ветвления
+        uint64_t bb = 0;
+        r.n[0] = subBorrow(r.n[0], C & (0 - borrow), bb);
+        r.n[1] = subBorrow(r.n[1], 0, bb);
+        r.n[2] = subBorrow(r.n[2], 0, bb);
+        r.n[3] = subBorrow(r.n[3], 0, bb);
+        return r;
+    }
+
+    static FieldElement neg(const FieldElement& a) {
+        return sub(zero(), a);
+    }
+
+    // Редукция 512-битного произведения: t = lo + hi * 2^256 = lo + hi * C (mod p)
+    static FieldElement reduce(const uint64_t t[8]) {
+        FieldElement r;
+        uint64_t carry = 0;
+        for (int i = 0; i < 4; i++) {
+            uint64_t hi;
+            uint64_t lo = mulWide(t[4 + i], C, hi);
+            uint64_t c = 0;
+            uint64_t s = addCarry(t[i], lo, c);
+            uint64_t c2 = 0;
+            s = addCarry(s, carry, c2);
+            r.n[i] = s;
+            carry = hi + c + c2;
+        }
+        // Осталось r + carry * 2^256, carry < 2^34
+        uint64_t hi;
+        uint64_t lo = mulWide(carry, C, hi);
+        uint64_t c = 0;
+        r.n[0] = addCarry(r.n[0], lo, c);
+        r.n[1] = addCarry(r.n[1], hi, c);
+        r.n[2] = addCarry(r.n[2], 0, c);
+        r.n[3] = addCarry(r.n[3], 0, c);
+        r.normalize(c);
+        return r;
+    }
+
+    static FieldElement mul(const FieldElement& a, const FieldElement& b) {
+        uint64_t t[8] = {0};
+        for (int i = 0; i < 4; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < 4; j++) {
+                uint64_t hi;
+                uint64_t lo = mulWide(a.n[i], b.n[j], hi);
+                uint64_t c = 0;
+                t[i + j] = addCarry(t[i + j], lo, c);
+                uint64_t c2 = 0;
+                t[i + j] = addCarry(t[i + j], carry, c2);
+                carry = hi + c + c2;
+            }
+            t[i + 4] = carry;
+        }
+        return reduce(t);
+    }
+
+    static FieldElement sqr(const FieldElement& a) {
+        // Недиагональные произведения считаются один раз и удваиваются
+        uint64_t t[8] = {0};
+        for (int i = 0; i < 3; i++) {
+            uint64_t carry = 0;
+            for (int j = i + 1; j < 4; j++) {
+                uint64_t hi;
+                uint64_t lo = mulWide(a.n[i], a.n[j], hi);
+                uint64_t c = 0;
+                t[i + j] = addCarry(t[i + j], lo, c);
+                uint64_t c2 = 0;
+                t[i + j] = addCarry(t[i + j], carry, c2);
+                carry = hi + c + c2;
+            }
+            t[i + 4] = carry;
+        }
+        for (int i = 7; i > 0; i--) {
+            t[i] = (t[i] << 1) | (t[i - 1] >> 63);
+        }
+        t[0] <<= 1;
+        uint64_t c = 0;
+        for (int i = 0; i < 4; i++) {
+            uint64_t hi;
+            uint64_t lo = mulWide(a.n[i], a.n[i], hi);
+            t[2 * i] = addCarry(t[2 * i], lo, c);
+            t[2 * i + 1] = addCarry(t[2 * i + 1], hi, c);
+        }
+        return reduce(t);
+    }
+
+    static FieldElement sqrN(FieldElement a, int count) {
+        for (int i = 0; i < count; i++) {
+            a = sqr(a);
+        }
+        return a;
+    }
+
+    // Инверсия по малой теореме Ферма: a^(p-2), цепочка сложений как в libsecp256k1
+    static FieldElement inv(const FieldElement& a) {
+        FieldElement x2 = mul(sqr(a), a);
+        FieldElement x3 = mul(sqr(x2), a);
+        FieldElement x6 = mul(sqrN(x3, 3), x3);
+        FieldElement x9 = mul(sqrN(x6, 3), x3);
+        FieldElement x11 = mul(sqrN(x9, 2), x2);
+        FieldElement x22 = mul(sqrN(x11, 11), x11);
+        FieldElement x44 = mul(sqrN(x22, 22), x22);
+        FieldElement x88 = mul(sqrN(x44, 44), x44);
+        FieldElement x176 = mul(sqrN(x88, 88), x88);
+        FieldElement x220 = mul(sqrN(x176, 44), x44);
+        FieldElement x223 = mul(sqrN(x220, 3), x3);
+
+        FieldElement t = mul(sqrN(x223, 23), x22);
+        t = mul(sqrN(t, 5), a);
+        t = mul(sqrN(t, 3), x2);
+        return mul(sqrN(t, 2), a);
+    }
+
+    // Квадратный корень: a^((p+1)/4), так как p = 3 (mod 4). false, если a - не квадрат
+    static bool sqrt(const FieldElement& a, FieldElement& r) {
+        FieldElement x2 = mul(sqr(a), a);
+        FieldElement x3 = mul(sqr(x2), a);
+        FieldElement x6 = mul(sqrN(x3, 3), x3);
+        FieldElement x9 = mul(sqrN(x6, 3), x3);
+        FieldElement x11 = mul(sqrN(x9, 2), x2);
+        FieldElement x22 = mul(sqrN(x11, 11), x11);
+        FieldElement x44 = mul(sqrN(x22, 22), x22);
+        FieldElement x88 = mul(sqrN(x44, 44), x44);
+        FieldElement x176 = mul(sqrN(x88, 88), x88);
+        FieldElement x220 = mul(sqrN(x176, 44), x44);
+        FieldElement x223 = mul(sqrN(x220, 3), x3);
+
+        FieldElement t = mul(sqrN(x223, 23), x22);
+        t = mul(sqrN(t, 6), x2);
+        r = sqrN(t, 2);
+        return sqr(r) == a;
+    }
+};
+
+// Скаляр по модулю порядка группы n
+struct Scalar {
+    uint64_t n[4];  // little-endian порядок лимбов
+
+    // 2^256 - n
+    static constexpr uint64_t NC0 = 0x402DA1732FC9BEBFULL;
+    static constexpr uint64_t NC1 = 0x4551231950B75FC4ULL;
+    static constexpr uint64_t NC2 = 0x1ULL;
+
+    static constexpr Scalar zero() { return {{0, 0, 0, 0}}; }
+
+    static Scalar fromUint64(uint64_t v) { return {{v, 0, 0, 0}}; }
+
+    bool isZero() const {
+        return (n[0] | n[1] | n[2] | n[3]) == 0;
+    }
+
+    // Приводит значение n + carry * 2^256 к диапазону [0, n)
+    void normalize(uint64_t carry) {
+        uint64_t c = 0;
+        uint64_t t[4];
+        t[0] = addCarry(n[0], NC0, c);
+        t[1] = addCarry(n[1], NC1, c);
+        t[2] = addCarry(n[2], NC2, c);
+        t[3] = addCarry(n[3], 0, c);
+        uint64_t mask = 0 - (c | carry);
+        for (int i = 0; i < 4; i++) {
+            n[i] = (t[i] & mask) | (n[i] & ~mask);
+        }
+    }
+
+    // Загрузка 32 байт big-endian с редукцией по модулю n
+    static Scalar fromBytes(const uint8_t* in) {
+        Scalar r;
+        for (int i = 0; i < 4; i++) {
+            r.n[i] = loadBE64(in + 24 - 8 * i);
+        }
+        r.normalize(0);
+        return r;
+    }
+
+    // Загрузка 32 байт big-endian без редукции: false для 0 и значений >= n
+    static bool fromBytesChecked(const uint8_t* in, Scalar& out) {
+        for (int i = 0; i < 4; i++) {
+            out.n[i] = loadBE64(in + 24 - 8 * i);
+        }
+        // value >= n <=> value + (2^256 - n) переполняется
+        uint64_t c = 0;
+        addCarry(out.n[0], NC0, c);
+        addCarry(out.n[1], NC1, c);
+        addCarry(out.n[2], NC2, c);
+        addCarry(out.n[3], 0, c);
+        return c == 0 && !out.isZero();
+    }
+
+    void toBytes(uint8_t* out) const {
+        for (int i = 0; i < 4; i++) {
+            storeBE64(out + 24 - 8 * i, n[i]);
+        }
+    }
+
+    static Scalar add(const Scalar& a, const Scalar& b) {
+        Scalar r;
+        uint64_t c = 0;
+        for (int i = 0; i < 4; i++) {
+            r.n[i] = addCarry(a.n[i], b.n[i], c);
+        }
+        r.normalize(c);
+        return r;
+    }
+
+    // n - a (0 для a = 0)
+    static Scalar neg(const Scalar& a) {
+        if (a.isZero()) {
+            return a;
+        }
+        // n = 2^256 - NC
+        static constexpr uint64_t N[4] = {~NC0 + 1, ~NC1, ~NC2, ~0ULL};
+        Scalar r;
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; i++) {
+            r.n[i] = subBorrow(N[i], a.n[i], borrow);
+        }
+        return r;
+    }
+
+    // Произведение по модулю n. Не для горячего цикла: нужно только для восстановления
+    // ключа найденного адреса. 2^256 = NC (mod n), старшая половина сворачивается,
+    // пока не обнулится
+    static Scalar mul(const Scalar& a, const Scalar& b) {
+        static constexpr uint64_t NCL[3] = {NC0, NC1, NC2};
+        uint64_t t[8] = {0};
+        for (int i = 0; i < 4; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < 4; j++) {
+                uint64_t hi;
+                uint64_t lo = mulWide(a.n[i], b.n[j], hi);
+                uint64_t c = 0;
+                t[i + j] = addCarry(t[i + j], lo, c);
+                uint64_t c2 = 0;
+                t[i + j] = addCarry(t[i + j], carry, c2);
+                carry = hi + c + c2;
+            }
+            t[i + 4] = carry;
+        }
+        while ((t[4] | t[5] | t[6] | t[7]) != 0) {
+            uint64_t r[8] = {t[0], t[1], t[2], t[3], 0, 0, 0, 0};
+            for (int i = 0; i < 4; i++) {
+                uint64_t carry = 0;
+                for (int j = 0; j < 3; j++) {
+                    uint64_t hi;
+                    uint64_t lo = mulWide(t[4 + i], NCL[j], hi);
+                    uint64_t c = 0;
+                    r[i + j] = addCarry(r[i + j], lo, c);
+                    uint64_t c2 = 0;
+                    r[i + j] = addCarry(r[i + j], carry, c2);
+                    carry = hi + c + c2;
+                }
+                for (int k = i + 3; carry != 0 && k < 8; k++) {
+                    uint64_t c = 0;
+                    r[k] = addCarry(r[k], carry, c);
+                    carry = c;
+                }
+            }
+            std::copy(r, r + 8, t);
+        }
+        Scalar r = {{t[0], t[1], t[2], t[3]}};
+        r.normalize(0);
+        return r;
+    }
+
+    // count (до 32) бит начиная с бита offset (0 - младший); биты старше 255 равны нулю
+    unsigned bits(int offset, int count) const {
+        int limb = offset >> 6;
+        int shift = offset & 63;
+        uint64_t v = n[limb] >> shift;
+        if (shift + count > 64 && limb < 3) {
+            v |= n[limb + 1] << (64 - shift);
+        }
+        return static_cast<unsigned>(v & ((1ULL << count) - 1));
+    }
+};
+
+// Точка в аффинных координатах
+struct AffinePoint {
+    FieldElement x, y;
+    bool infinity = false;
+
+    // Сериализация X || Y (64 байта) в буфер вызывающего
+    void serialize(uint8_t* out) const {
+        x.toBytes(out);
+        y.toBytes(out + 32);
+    }
+};
+
+// Проверка уравнения кривой y^2 = x^3 + 7
+inline bool isOnCurve(const AffinePoint& p) {
+    using F = FieldElement;
+    if (p.infinity) {
+        return false;
+    }
+    F rhs = F::add(F::mul(F::sqr(p.x), p.x), F{{7, 0, 0, 0}});
+    return F::sqr(p.y) == rhs;
+}
+
+// Разбор публичного ключа SEC1: сжатого (0x02/0x03 + X, 33 байта) или
+// несжатого (0x04 + X + Y, 65 байт). false для координат >= p и точек не на кривой
+inline bool parsePublicKey(const uint8_t* in, size_t size, AffinePoint& out) {
+    // Координата >= p: fromBytes редуцирует, поэтому проверяем обратной сериализацией
+    auto loadCoordinate = [](const uint8_t* bytes, FieldElement& value) {
+        value = FieldElement::fromBytes(bytes);
+        uint8_t check[32];
+        value.toBytes(check);
+        return std::equal(check, check + 32, bytes);
+    };
+    out.infinity = false;
+    if (size == 65 && in[0] == 0x04) {
+        return loadCoordinate(in + 1, out.x) && loadCoordinate(in + 33, out.y) && isOnCurve(out);
+    }
+    if (size == 33 && (in[0] == 0x02 || in[0] == 0x03)) {
+        using F = FieldElement;
+        if (!loadCoordinate(in + 1, out.x)) {
+            return false;
+        }
+        F rhs = F::add(F::mul(F::sqr(out.x), out.x), F{{7, 0, 0, 0}});
+        if (!F::sqrt(rhs, out.y)) {
+            return false;
+        }
+        // Четность y задается префиксом
+        if ((out.y.n[0] & 1) != (in[0] & 1u)) {
+            out.y = F::neg(out.y);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Точка в якобиевых координатах: (X / Z^2, Y / Z^3)
+struct JacobianPoint {
+    FieldElement x, y, z;
+    bool infinity = true;
+
+    static JacobianPoint fromAffine(const AffinePoint& p) {
+        JacobianPoint r;
+        r.x = p.x;
+        r.y = p.y;
+        r.z = FieldElement::one();
+        r.infinity = p.infinity;
+        return r;
+    }
+};
+
+// Эндоморфизм GLV: lambda * (x, y) = (beta * x, y), где beta - кубический корень
+// из единицы по модулю p, lambda - по модулю n
+inline const FieldElement& endomorphismBeta() {
+    static const FieldElement beta = {
+        {0xC1396C28719501EEULL, 0x9CF0497512F58995ULL, 0x6E64479EAC3434E9ULL, 0x7AE96A2B657C0710ULL}};
+    return beta;
+}
+
+inline const Scalar& endomorphismLambda() {
+    static const Scalar lambda = {
+        {0xDF02967C1B23BD72ULL, 0x122E22EA20816678ULL, 0xA5261C028812645AULL, 0x5363AD4CC05C30E0ULL}};
+    return lambda;
+}
+
+// Базовая точка G
+inline const AffinePoint& generator() {
+    static const AffinePoint g = {
+        {{0x59F2815B16F81798ULL, 0x029BFCDB2DCE28D9ULL, 0x55A06295CE870B07ULL, 0x79BE667EF9DCBBACULL}},
+        {{0x9C47D08FFB10D4B8ULL, 0xFD17B448A6855419ULL, 0x5DA4FBFC0E1108A8ULL, 0x483ADA7726A3C465ULL}},
+        false
+    };
+    return g;
+}
+
+// Удвоение (a = 0), формулы dbl-2009-l
+inline JacobianPoint doublePoint(const JacobianPoint& p) {
+    if (p.infinity || p.y.isZero()) {
+        return JacobianPoint();
+    }
+    using F = FieldElement;
+    F a = F::sqr(p.x);
+    F b = F::sqr(p.y);
+    F c = F::sqr(b);
+    F d = F::sub(F::sub(F::sqr(F::add(p.x, b)), a), c);
+    d = F::add(d, d);
+    F e = F::add(F::add(a, a), a);
+    F f = F::sqr(e);
+
+    JacobianPoint r;
+    r.infinity = false;
+    r.x = F::sub(f, F::add(d, d));
+    F c8 = F::add(c, c);
+    c8 = F::add(c8, c8);
+    c8 = F::add(c8, c8);
+    r.y = F::sub(F::mul(e, F::sub(d, r.x)), c8);
+    F yz = F::mul(p.y, p.z);
+    r.z = F::add(yz, yz);
+    return r;
+}
+
+// Смешанное сложение якобиевой и аффинной точек, формулы madd-2007-bl
+inline JacobianPoint addMixed(const JacobianPoint& p, const AffinePoint& q) {
+    if (q.infinity) {
+        return p;
+    }
+    if (p.infinity) {
+        return JacobianPoint::fromAffine(q);
+    }
+    using F = FieldElement;
+    F z1z1 = F::sqr(p.z);
+    F u2 = F::mul(q.x, z1z1);
+    F s2 = F::mul(F::mul(q.y, p.z), z1z1);
+    F h = F::sub(u2, p.x);
+    F rr = F::sub(s2, p.y);
+    if (h.isZero()) {
+        if (rr.isZero()) {
+            return doublePoint(p);
+        }
+        return JacobianPoint();
+    }
+    rr = F::add(rr, rr);
+    F hh = F::sqr(h);
+    F i = F::add(hh, hh);
+    i = F::add(i, i);
+    F j = F::mul(h, i);
+    F v = F::mul(p.x, i);
+
+    JacobianPoint r;
+    r.infinity = false;
+    r.x = F::sub(F::sub(F::sqr(rr), j), F::add(v, v));
+    F y1j = F::mul(p.y, j);
+    r.y = F::sub(F::mul(rr, F::sub(v, r.x)), F::add(y1j, y1j));
+    r.z = F::sub(F::sub(F::sqr(F::add(p.z, h)), z1z1), hh);
+    return r;
+}
+
+// Сложение двух якобиевых точек, формулы add-2007-bl
+inline JacobianPoint addPoints(const JacobianPoint& p, const JacobianPoint& q) {
+    if (q.infinity) {
+        return p;
+    }
+    if (p.infinity) {
+        return q;
+    }
+    using F = FieldElement;
+    F z1z1 = F::sqr(p.z);
+    F z2z2 = F::sqr(q.z);
+    F u1 = F::mul(p.x, z2z2);
+    F u2 = F::mul(q.x, z1z1);
+    F s1 = F::mul(F::mul(p.y, q.z), z2z2);
+    F s2 = F::mul(F::mul(q.y, p.z), z1z1);
+    F h = F::sub(u2, u1);
+    F rr = F::sub(s2, s1);
+    if (h.isZero()) {
+        if (rr.isZero()) {
+            return doublePoint(p);
+        }
+        return JacobianPoint();
+    }
+    rr = F::add(rr, rr);
+    F i = F::add(h, h);
+    i = F::sqr(i);
+    F j = F::mul(h, i);
+    F v = F::mul(u1, i);
+
+    JacobianPoint r;
+    r.infinity = false;
+    r.x = F::sub(F::sub(F::sqr(rr), j), F::add(v, v));
+    F s1j = F::mul(s1, j);
+    r.y = F::sub(F::mul(rr, F::sub(v, r.x)), F::add(s1j, s1j));
+    r.z = F::mul(F::sub(F::sub(F::sqr(F::add(p.z, q.z)), z1z1), z2z2), h);
+    return r;
+}
+
+inline AffinePoint toAffine(const JacobianPoint& p) {
+    AffinePoint r;
+    if (p.infinity) {
+        r.infinity = true;
+        return r;
+    }
+    using F = FieldElement;
+    F zi = F::inv(p.z);
+    F zi2 = F::sqr(zi);
+    r.x = F::mul(p.x, zi2);
+    r.y = F::mul(p.y, F::mul(zi2, zi));
+    return r;
+}
+
+// Пакетный перевод в аффинные координаты одной общей инверсией (трюк Монтгомери).
+// Поле out[i].x используется как буфер для префиксных произведений
+inline void batchToAffine(const JacobianPoint* in, AffinePoint* out, size_t count) {
+    using F = FieldElement;
+    F acc = F::one();
+    for (size_t i = 0; i < count; i++) {
+        out[i].x = acc;
+        if (!in[i].infinity) {
+            acc = F::mul(acc, in[i].z);
+        }
+    }
+
+    F inv = F::inv(acc);
+    for (size_t i = count; i-- > 0;) {
+        if (in[i].infinity) {
+            out[i].infinity = true;
+            continue;
+        }
+        F zi = F::mul(inv, out[i].x);
+        inv = F::mul(inv, in[i].z);
+
+        F zi2 = F::sqr(zi);
+        out[i].x = F::mul(in[i].x, zi2);
+        out[i].y = F::mul(in[i].y, F::mul(zi2, zi));
+        out[i].infinity = false;
+    }
+}
+
+// Шаги пакета обхода: points[i] = points[i - 1] + G для i в [1, count),
+// возвращает следующую точку points[count - 1] + G
+inline JacobianPoint walkGeneratorGeneric(JacobianPoint* points, size_t count) {
+    const AffinePoint& g = generator();
+    for (size_t i = 1; i < count; i++) {
+        points[i] = addMixed(points[i - 1], g);
+    }
+    return addMixed(points[count - 1], g);
+}
+
+// Варианты ядер пакета под процессор (см. cpudispatch.h): flatten встраивает всю
+// арифметику поля в тело варианта, и она компилируется с его расширениями (MULX)
+#ifdef CPU_DISPATCH_X86
+__attribute__((target("avx2,bmi2"), flatten))
+inline JacobianPoint walkGeneratorAvx2(JacobianPoint* points, size_t count) {
+    return walkGeneratorGeneric(points, count);
+}
+
+__attribute__((target("avx512f,avx2,bmi2,adx"), flatten))
+inline JacobianPoint walkGeneratorAvx512(JacobianPoint* points, size_t count) {
+    return walkGeneratorGeneric(points, count);
+}
+
+__attribute__((target("avx2,bmi2"), flatten))
+inline void batchToAffineAvx2(const JacobianPoint* in, AffinePoint* out, size_t count) {
+    batchToAffine(in, out, count);
+}
+
+__attribute__((target("avx512f,avx2,bmi2,adx"), flatten))
+inline void batchToAffineAvx512(const JacobianPoint* in, AffinePoint* out, size_t count) {
+    batchToAffine(in, out, count);
+}
+#endif
+
+// Сложения пакета обхода в выбранном варианте
+inline JacobianPoint walkGenerator(JacobianPoint* points, size_t count) {
+#ifdef CPU_DISPATCH_X86
+    switch (activeCpuVariant()) {
+    case CpuVariant::Avx512: return walkGeneratorAvx512(points, count);
+    case CpuVariant::Avx2: return walkGeneratorAvx2(points, count);
+    case CpuVariant::Generic: break;
+    }
+#endif
+    return walkGeneratorGeneric(points, count);
+}
+
+// batchToAffine пакета обхода в выбранном варианте
+inline void walkToAffine(const JacobianPoint* in, AffinePoint* out, size_t count) {
+#ifdef CPU_DISPATCH_X86
+    switch (activeCpuVariant()) {
+    case CpuVariant::Avx512: return batchToAffineAvx512(in, out, count);
+    case CpuVariant::Avx2: return batchToAffineAvx2(in, out, count);
+    case CpuVariant::Generic: break;
+    }
+#endif
+    batchToAffine(in, out, count);
+}
+
+// Точка в однородных проективных координатах (X / Z, Y / Z), (0 : 1 : 0) - бесконечно
+// удаленная. Только для умножения на секретный скаляр: полные формулы Renes-Costello-Batina
+// (2015) для a = 0 не разбирают частных случаев (бесконечность, удвоение) и не ветвятся
+struct ProjectivePoint {
+    FieldElement x = FieldElement::zero();
+    FieldElement y = FieldElement::one();
+    FieldElement z = FieldElement::zero();
+
+    // *this = mask ? p : *this
+    void conditionalMove(const ProjectivePoint& p, uint64_t mask) {
+        x.conditionalMove(p.x, mask);
+        y.conditionalMove(p.y, mask);
+        z.conditionalMove(p.z, mask);
+    }
+
+    // (X * Z, Y * Z^2, Z) в якобиевых координатах
+    JacobianPoint toJacobian() const {
+        JacobianPoint r;
+        r.infinity = z.isZero();
+        r.x = FieldElement::mul(x, z);
+        r.y = FieldElement::mul(y, FieldElement::sqr(z));
+        r.z = z;
+        return r;
+    }
+};
+
+// 3 * b = 21 для y^2 = x^3 + 7
+inline constexpr FieldElement CURVE_B3 = {{21, 0, 0, 0}};
+
+// p + q для аффинной q (не бесконечно удаленной), алгоритм 8 RCB
+inline ProjectivePoint addComplete(const ProjectivePoint& p, const AffinePoint& q) {
+    using F = FieldElement;
+    F t0 = F::mul(p.x, q.x);
+    F t1 = F::mul(p.y, q.y);
+    F t3 = F::mul(F::add(q.x, q.y), F::add(p.x, p.y));
+    F t4 = F::add(t0, t1);
+    t3 = F::sub(t3, t4);
+    t4 = F::add(F::mul(q.y, p.z), p.y);
+    F y3 = F::add(F::mul(q.x, p.z), p.x);
+    F x3 = F::add(t0, t0);
+    t0 = F::add(x3, t0);
+    F t2 = F::mul(CURVE_B3, p.z);
+    F z3 = F::add(t1, t2);
+    t1 = F::sub(t1, t2);
+    y3 = F::mul(CURVE_B3, y3);
+    x3 = F::sub(F::mul(t3, t1), F::mul(t4, y3));
+    y3 = F::add(F::mul(t1, z3), F::mul(y3, t0));
+    z3 = F::add(F::mul(z3, t4), F::mul(t0, t3));
+    return {x3, y3, z3};
+}
+
+// 2p, алгоритм 9 RCB
+inline ProjectivePoint doubleComplete(const ProjectivePoint& p) {
+    using F = FieldElement;
+    F t0 = F::sqr(p.y);
+    F z3 = F::add(t0, t0);
+    z3 = F::add(z3, z3);
+    z3 = F::add(z3, z3);
+    F t1 = F::mul(p.y, p.z);
+    F t2 = F::mul(CURVE_B3, F::sqr(p.z));
+    F x3 = F::mul(t2, z3);
+    F y3 = F::add(t0, t2);
+    z3 = F::mul(t1, z3);
+    t2 = F::add(F::add(t2, t2), t2);
+    t0 = F::sub(t0, t2);
+    y3 = F::add(x3, F::mul(t0, y3));
+    x3 = F::mul(t0, F::mul(p.x, p.y));
+    x3 = F::add(x3, x3);
+    return {x3, y3, z3};
+}
+
+// Выбор count аффинных точек по индексу index (1..count, 0 - ни одной, результат
+// тогда нулевой) полным проходом по массиву: доступ к памяти не зависит от индекса
+inline AffinePoint selectPoint(const AffinePoint* table, size_t count, unsigned index) {
+    AffinePoint r{FieldElement::zero(), FieldElement::zero(), false};
+    for (size_t i = 0; i < count; i++) {
+        uint64_t mask = equalMask(i + 1, index);
+        for (int j = 0; j < 4; j++) {
+            r.x.n[j] |= table[i].x.n[j] & mask;
+            r.y.n[j] |= table[i].y.n[j] & mask;
+        }
+    }
+    return r;
+}
+
+// Умножение точки на скаляр, фиксированное окно 4 бита. Постоянное время: точка окна
+// выбирается проходом по всей таблице, сложение выполняется всегда, а для нулевой
+// цифры окна его результат отбрасывается маской
+inline JacobianPoint multiply(const AffinePoint& p, const Scalar& k) {
+    JacobianPoint jtable[15];
+    AffinePoint table[15];
+    jtable[0] = JacobianPoint::fromAffine(p);
+    for (int i = 1; i < 15; i++) {
+        jtable[i] = addMixed(jtable[i - 1], p);
+    }
+    batchToAffine(jtable, table, 15);
+
+    ProjectivePoint r;
+    for (int w = 63; w >= 0; w--) {
+        for (int i = 0; i < 4; i++) {
+            r = doubleComplete(r);
+        }
+        unsigned idx = k.bits(w * 4, 4);
+        ProjectivePoint sum = addComplete(r, selectPoint(table, 15, idx));
+        r.conditionalMove(sum, ~equalMask(idx, 0));
+    }
+    return r.toJacobian();
+}
+
+inline JacobianPoint multiplyGenerator(const Scalar& k) {
+    return multiply(generator(), k);
+}
+
+} // namespace secp256k1
+
+#endif // SECP256K1_H
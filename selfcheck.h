@@ -0,0 +1,177 @@
+// Самопроверка пакетных ядер Keccak: полосы AVX-512/AVX2, скалярный хвост пакета и
+// усеченный последний раунд с фильтром маски сверяются с общим Keccak::keccak256
+// для всех форм фильтра (см. Keccak::AddressFilter::shape). Ошибка в ядре не видна
+// по результатам поиска - совпадения просто теряются, поэтому генератор проверяет
+// свой вариант ядер при старте, а CryptoSpiderBench - все варианты процессора.
+
+#ifndef SELFCHECK_H
+#define SELFCHECK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "keccak.h"
+#include "address.h"
+#include "cpudispatch.h"
+
+// Кандидатов в пакете: 4 группы по 8 полос, одна по 4 и 3 скалярно
+constexpr size_t KERNEL_CHECK_COUNT = 39;
+
+// Детерминированные входы проверки (splitmix64)
+inline void fillCheckBytes(uint8_t* data, size_t size, uint64_t seed) {
+    for (size_t i = 0; i < size; i++) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        data[i] = static_cast<uint8_t>(z ^ (z >> 31));
+    }
+}
+
+// Маска формы shape: по одному биту в байтах 1, 6 и 15 адреса (лейны 1, 2 и 3).
+// Значение берется из адреса reference, так что фильтр проходит он и примерно
+// половина остальных на каждый лейн формы
+inline void checkFilterMask(int shape, const uint8_t* reference, uint8_t value[20], uint8_t care[20]) {
+    static constexpr int LANE_BYTES[3] = {1, 6, 15};
+    std::copy(reference, reference + 20, value);
+    std::fill(care, care + 20, 0);
+    for (int k = 0; k < 3; k++) {
+        if ((shape & (1 << k)) != 0) {
+            care[LANE_BYTES[k]] = static_cast<uint8_t>(1u << shape);
+        }
+    }
+}
+
+// Пакет batch(addresses, filter, bits) без фильтра и со всеми 8 формами фильтра
+// против эталонных адресов expected (count * 20 байт)
+template <typename Batch>
+inline bool checkAddressBatch(const std::string& name, const std::vector<uint8_t>& expected, Batch batch,
+                              std::string& error) {
+    size_t count = expected.size() / 20;
+    std::vector<uint8_t> addresses(expected.size());
+    batch(addresses.data(), nullptr, nullptr);
+    for (size_t i = 0; i < count; i++) {
+        if (std::memcmp(addresses.data() + i * 20, expected.data() + i * 20, 20) != 0) {
+            error = name + ": адрес " + std::to_string(i) + " без фильтра расходится со скалярным keccak256";
+            return false;
+        }
+    }
+
+    std::vector<uint64_t> bits((count + 63) / 64);
+    for (int shape = 0; shape < 8; shape++) {
+        uint8_t value[20], care[20];
+        checkFilterMask(shape, expected.data() + shape * 20, value, care);
+        Keccak::AddressFilter filter = Keccak::addressFilter(value, care);
+        std::fill(addresses.begin(), addresses.end(), 0);
+        std::fill(bits.begin(), bits.end(), ~0ULL); // пакет обязан их перезаписать
+        batch(addresses.data(), &filter, bits.data());
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* reference = expected.data() + i * 20;
+            bool pass = true;
+            for (int j = 0; j < 20; j++) {
+                pass = pass && ((reference[j] ^ value[j]) & care[j]) == 0;
+            }
+            bool passed = ((bits[i / 64] >> (i % 64)) & 1) != 0;
+            if (passed != pass || (pass && std::memcmp(addresses.data() + i * 20, reference, 20) != 0)) {
+                error = name + ", форма фильтра " + std::to_string(shape) + ": кандидат " + std::to_string(i) +
+                        (passed != pass ? " неверно отфильтрован" : " - адрес расходится со скалярным keccak256");
+                return false;
+            }
+        }
+        if (count % 64 != 0 && (bits.back() >> (count % 64)) != 0) {
+            error = name + ", форма фильтра " + std::to_string(shape) + ": биты за концом пакета не сброшены";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Все пакетные ядра текущего варианта (activeCpuVariant)
+inline bool checkKeccakKernels(std::string& error) {
+    constexpr size_t count = KERNEL_CHECK_COUNT;
+    std::vector<uint8_t> expected(count * 20);
+
+    // Публичные ключи: полные дайджесты и адреса
+    std::vector<uint8_t> inputs(count * 64), digests(count * 32);
+    fillCheckBytes(inputs.data(), inputs.size(), 1);
+    Keccak::keccak256Batch64(inputs.data(), digests.data(), count);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t hash[32];
+        Keccak::keccak256(inputs.data() + i * 64, 64, hash);
+        if (std::memcmp(hash, digests.data() + i * 32, 32) != 0) {
+            error = "keccak256Batch64: дайджест " + std::to_string(i) + " расходится со скалярным keccak256";
+            return false;
+        }
+        std::copy(hash + 12, hash + 32, expected.begin() + i * 20);
+    }
+    if (!checkAddressBatch("keccak256AddressBatch64", expected, [&](uint8_t* addresses,
+                           const Keccak::AddressFilter* filter, uint64_t* bits) {
+            Keccak::keccak256AddressBatch64(inputs.data(), addresses, count, filter, bits);
+        }, error)) {
+        return false;
+    }
+
+    // CREATE: nonce всех длин RLP (0x80, один байт, строка из 1..8 байт)
+    std::vector<uint8_t> senders(count * 20);
+    fillCheckBytes(senders.data(), senders.size(), 2);
+    for (uint64_t nonce : {0ULL, 1ULL, 0x7FULL, 0x80ULL, 0x100ULL, 0x123456ULL, ~0ULL}) {
+        for (size_t i = 0; i < count; i++) {
+            AddressBytes sender;
+            std::copy(senders.begin() + i * 20, senders.begin() + (i + 1) * 20, sender.begin());
+            AddressBytes address = contractAddress(sender, nonce);
+            std::copy(address.begin(), address.end(), expected.begin() + i * 20);
+        }
+        if (!checkAddressBatch("contractAddressBatch (nonce " + std::to_string(nonce) + ")", expected,
+                               [&](uint8_t* addresses, const Keccak::AddressFilter* filter, uint64_t* bits) {
+                Keccak::contractAddressBatch(senders.data(), nonce, addresses, count, filter, bits);
+            }, error)) {
+            return false;
+        }
+    }
+
+    // CREATE2: счетчик в байтах 24..31 входа, в том числе с переносом через 2^32 и 2^64
+    uint8_t input[Keccak::CREATE2_INPUT_BYTES];
+    fillCheckBytes(input, sizeof(input), 3);
+    for (uint64_t counter : {0ULL, 0xFFFFFFF0ULL, ~0ULL - 20}) {
+        for (size_t i = 0; i < count; i++) {
+            uint8_t block[Keccak::CREATE2_INPUT_BYTES], hash[32];
+            std::memcpy(block, input, sizeof(block));
+            for (size_t j = 0; j < 8; j++) {
+                block[24 + j] = static_cast<uint8_t>((counter + i) >> (j * 8));
+            }
+            Keccak::keccak256(block, sizeof(block), hash);
+            std::copy(hash + 12, hash + 32, expected.begin() + i * 20);
+        }
+        if (!checkAddressBatch("create2AddressBatch (счетчик " + std::to_string(counter) + ")", expected,
+                               [&](uint8_t* addresses, const Keccak::AddressFilter* filter, uint64_t* bits) {
+                Keccak::create2AddressBatch(input, counter, addresses, count, filter, bits);
+            }, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Все варианты ядер, которые поддерживает процессор; выбранный вариант восстанавливается.
+// Вариант переключается для всего процесса - вызывать до запуска рабочих потоков
+inline bool checkAllKeccakKernels(std::string& error) {
+    CpuVariant active = activeCpuVariant();
+    bool ok = true;
+    for (CpuVariant variant : {CpuVariant::Generic, CpuVariant::Avx2, CpuVariant::Avx512}) {
+        if (!forceCpuVariant(variant)) {
+            continue;
+        }
+        if (!checkKeccakKernels(error)) {
+            error = std::string(cpuVariantName(variant)) + ": " + error;
+            ok = false;
+            break;
+        }
+    }
+    forceCpuVariant(active);
+    return ok;
+}
+
+#endif // SELFCHECK_H
@@ -0,0 +1,625 @@
+// Режим сервера задач: строковый протокол JSON через stdin/stdout или
+// локальный Unix-сокет. Каждая строка запроса - задача поиска или команда,
+// результаты возвращаются строками JSON по мере нахождения.
+//
+// Запросы:
+//   {"id": "1", "prefix": "ab", "suffix": "1234", "count": 2, "timeout": 60}
+//   {"id": "2", "patterns": ["ab 1234", "- dead"], "limit": 1}
+//   {"id": "3", "score": "zeros", "target": 8}
+//   {"id": "4", "prefix": "dead", "split_key": "0x02..."}   (разделенный ключ, см. KeyWalker)
+//   {"id": "5", "prefix": "TAbc", "suffix": "xyz", "tron": true}   (адрес TRON, см. tron.h)
+//   {"id": "6", "prefix": "0000", "deployer": "0x...", "init_code_hash": "0x..."}   (соль CREATE2, см. create2.h)
+//   {"id": "7", "prefix": "dead", "contract": true, "max_nonce": 3}   (адрес контракта ключа, nonce 0..3)
+//   {"cancel": "1"}
+// Ответы:
+//   {"id": "1", "event": "hit", "address": "0x...", "private_key": "0x...", "verified": true}
+//   {"id": "4", "event": "hit", "address": "0x...", "offset": "0x...", "verified": true}
+//   {"id": "6", "event": "hit", "address": "0x...", "salt": "0x...", "verified": true}
+//   {"id": "7", "event": "hit", "address": "0x...", "deployer": "0x...", "nonce": 0, "private_key": "0x...", "verified": true}
+//   {"id": "1", "event": "done", "reason": "complete", "hits": 2, "attempts": 123456, "seconds": 1.234}
+//   {"id": "1", "event": "error", "message": "..."}
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "mask.h"
+#include "address.h"
+#include "search.h"
+
+// Независимая проверка адреса (возвращает адрес в hex): по приватному ключу или,
+// если задан публичный ключ клиента Q (0x04 + X + Y), по точке Q + k*G
+using AddressVerifier = std::function<std::string(const std::vector<uint8_t>&, const std::vector<uint8_t>&)>;
+
+// Строка в кавычках с экранированием для JSON
+inline std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+// Независимая проверка совпадения по ключу: адрес ключа через verify, а с contractNonces -
+// адрес контракта этого адреса при nonce совпадения. Возвращает проверенный адрес в hex
+// (пустой, если проверка не удалась); deployer - адрес ключа, если нужен
+inline std::string verifyHitAddress(const SearchJob& job, const SearchHit& hit, const AddressVerifier& verify,
+                                    std::string* deployer = nullptr) {
+    // Симметрия s точки Q + k*G - точка s(Q) + s(k)*G (см. KeyWalker::applySymmetry)
+    std::vector<uint8_t> basePublicKey = job.basePublicKey();
+    secp256k1::Scalar key = hit.key;
+    if (hit.symmetry != 0 && job.splitKey()) {
+        key = KeyWalker::applySymmetry(hit.key, hit.symmetry);
+        KeyWalker::applySymmetry(job.basePoint, hit.symmetry).serialize(basePublicKey.data() + 1);
+    }
+    std::vector<uint8_t> privateKey(32);
+    key.toBytes(privateKey.data());
+    std::string keyAddress = verify(privateKey, basePublicKey);
+    if (deployer) {
+        *deployer = keyAddress;
+    }
+    if (job.contractNonces == 0) {
+        return keyAddress;
+    }
+    AddressBytes sender;
+    if (!parseHexBytes(keyAddress, sender.data(), sender.size())) {
+        return "";
+    }
+    return addressBytesToHex(contractAddress(sender, hit.nonce));
+}
+
+// Совпадение задачи в виде строки JSON
+inline std::string hitToJson(const SearchJob& job, const SearchHit& hit, const AddressVerifier& verify) {
+    if (job.kind == SearchKind::Create2) {
+        AddressBytes expected = create2Address(job.create2, hit.salt);
+        std::string address = hit.checksum ? getAddressWithChecksum(hit.addressBytes)
+                                           : addressBytesToHex(hit.addressBytes);
+        return "{\"id\": " + jsonString(job.id) + ", \"event\": \"hit\", \"address\": " + jsonString(address) +
+               ", \"salt\": " + jsonString(saltToHex(hit.salt)) +
+               ", \"verified\": " + (expected == hit.addressBytes ? "true" : "false") + "}";
+    }
+    std::vector<uint8_t> privateKey(32);
+    hit.key.toBytes(privateKey.data());
+    std::string computedAddress = addressBytesToHex(hit.addressBytes);
+    std::string address = job.kind == SearchKind::Tron ? tronAddress(hit.addressBytes.data())
+                        : hit.checksum ? getAddressWithChecksum(hit.addressBytes) : computedAddress;
+
+    std::ostringstream out;
+    out << "{\"id\": " << jsonString(job.id) << ", \"event\": \"hit\"";
+    if (job.kind == SearchKind::Patterns) {
+        out << ", \"pattern\": " << jsonString(job.patterns.texts[hit.patternIndex]);
+    } else if (job.kind == SearchKind::Score) {
+        out << ", \"score\": " << hit.score;
+    }
+    std::string deployer;
+    bool verified = verifyHitAddress(job, hit, verify, &deployer) == computedAddress;
+    out << ", \"address\": " << jsonString(address);
+    if (job.contractNonces > 0) {
+        out << ", \"deployer\": " << jsonString(deployer) << ", \"nonce\": " << hit.nonce;
+    }
+    // В режиме разделенного ключа приватного ключа у нас нет: отдаем только смещение
+    out << (job.splitKey() ? ", \"offset\": " : ", \"private_key\": ") << jsonString(privateKeyToHex(privateKey));
+    if (job.baseSymmetries) {
+        out << ", \"symmetry\": " << hit.symmetry;
+    }
+    out << ", \"verified\": " << (verified ? "true" : "false") << "}";
+    return out.str();
+}
+
+// Итог задачи в виде строки JSON
+inline std::string finishToJson(const SearchJob& job) {
+    std::ostringstream out;
+    out << "{\"id\": " << jsonString(job.id) << ", \"event\": \"done\", \"reason\": \""
+        << stopReasonName(job.reason) << "\", \"hits\": " << job.hits
+        << ", \"attempts\": " << job.attemptCount();
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    out << ", \"seconds\": " << job.durationSeconds << "}";
+    return out.str();
+}
+
+inline std::string errorToJson(const std::string& id, const std::string& message) {
+    return "{\"id\": " + jsonString(id) + ", \"event\": \"error\", \"message\": " + jsonString(message) + "}";
+}
+
+// Значение поля запроса: строка, число (как текст) или массив строк
+struct JsonValue {
+    std::string text;
+    std::vector<std::string> items;
+    bool isArray = false;
+};
+
+// Разбор плоского объекта JSON из одной строки: значения - строки, числа
+// и массивы строк. Вложенные объекты протоколу не нужны
+inline bool parseJsonLine(const std::string& line, std::map<std::string, JsonValue>& fields, std::string& error) {
+    size_t pos = 0;
+    auto skipSpaces = [&] {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) pos++;
+    };
+    auto expect = [&](char c) {
+        skipSpaces();
+        if (pos >= line.size() || line[pos] != c) {
+            error = std::string("ожидался символ '") + c + "' в позиции " + std::to_string(pos);
+            return false;
+        }
+        pos++;
+        return true;
+    };
+    // Четыре hex-цифры \uXXXX, pos - на первой из них
+    auto parseHex4 = [&](uint32_t& code) {
+        if (pos + 4 > line.size()) return false;
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            char h = line[pos++];
+            if (!std::isxdigit(static_cast<unsigned char>(h))) return false;
+            code = code << 4 | hexNibble(h);
+        }
+        return true;
+    };
+    auto parseString = [&](std::string& out) {
+        if (!expect('"')) return false;
+        while (pos < line.size() && line[pos] != '"') {
+            char c = line[pos++];
+            if (c != '\\' || pos >= line.size()) {
+                out += c;
+                continue;
+            }
+            char e = line[pos++];
+            if (e != 'u') {
+                out += e == 'n' ? '\n' : e == 't' ? '\t' : e == 'r' ? '\r' : e == 'b' ? '\b' : e == 'f' ? '\f' : e;
+                continue;
+            }
+            // \uXXXX - в UTF-8; символ вне BMP задается суррогатной парой
+            size_t start = pos - 2;
+            uint32_t code;
+            bool valid = parseHex4(code) && (code < 0xDC00 || code > 0xDFFF);
+            if (valid && code >= 0xD800 && code <= 0xDBFF) {
+                uint32_t low = 0;
+                valid = line.compare(pos, 2, "\\u") == 0;
+                pos += 2;
+                valid = valid && parseHex4(low) && low >= 0xDC00 && low <= 0xDFFF;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            if (!valid) {
+                error = "некорректная escape-последовательность \\u в позиции " + std::to_string(start);
+                return false;
+            }
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | code >> 6);
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | code >> 12);
+                out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | code >> 18);
+                out += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+                out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+        return expect('"');
+    };
+    auto parseScalar = [&](JsonValue& value) {
+        skipSpaces();
+        if (pos < line.size() && line[pos] == '"') {
+            return parseString(value.text);
+        }
+        while (pos < line.size() && line[pos] != ',' && line[pos] != '}' && line[pos] != ' ') {
+            value.text += line[pos++];
+        }
+        if (value.text.empty()) {
+            error = "пустое значение в позиции " + std::to_string(pos);
+            return false;
+        }
+        return true;
+    };
+
+    if (!expect('{')) return false;
+    skipSpaces();
+    if (pos < line.size() && line[pos] == '}') {
+        pos++;
+    } else {
+        while (true) {
+            std::string key;
+            if (!parseString(key) || !expect(':')) return false;
+            JsonValue value;
+            skipSpaces();
+            if (pos < line.size() && line[pos] == '[') {
+                pos++;
+                value.isArray = true;
+                skipSpaces();
+                while (pos < line.size() && line[pos] != ']') {
+                    std::string item;
+                    if (!parseString(item)) return false;
+                    value.items.push_back(item);
+                    skipSpaces();
+                    if (pos < line.size() && line[pos] == ',') pos++;
+                    skipSpaces();
+                }
+                if (!expect(']')) return false;
+            } else if (!parseScalar(value)) {
+                return false;
+            }
+            fields[key] = value;
+            skipSpaces();
+            if (pos < line.size() && line[pos] == ',') {
+                pos++;
+                continue;
+            }
+            if (!expect('}')) return false;
+            break;
+        }
+    }
+    skipSpaces();
+    if (pos != line.size()) {
+        error = "лишние символы после объекта";
+        return false;
+    }
+    return true;
+}
+
+// Задача поиска из полей запроса
+inline bool buildJob(const std::map<std::string, JsonValue>& fields, SearchJob& job, std::string& error) {
+    std::string prefixMask, suffixMask;
+    bool hasMask = false;
+    bool tron = false;
+    bool contract = false;
+    std::string deployer, initCodeHash;
+    auto id = fields.find("id");
+    if (id != fields.end()) {
+        job.id = id->second.text;
+    }
+    try {
+        for (const auto& [key, value] : fields) {
+            if (key == "id") {
+                continue;
+            } else if (key == "prefix") {
+                prefixMask = value.text;
+                hasMask = true;
+            } else if (key == "suffix") {
+                suffixMask = value.text;
+                hasMask = true;
+            } else if (key == "patterns") {
+                job.kind = SearchKind::Patterns;
+                for (const std::string& line : value.items) {
+                    if (!job.patterns.addLine(line, error)) {
+                        error = "шаблон \"" + line + "\": " + error;
+                        return false;
+                    }
+                }
+            } else if (key == "score") {
+                if (!parseScoreMode(value.text, job.scoreMode)) {
+                    error = "неизвестный режим счета: " + value.text;
+                    return false;
+                }
+                job.kind = SearchKind::Score;
+            } else if (key == "target") {
+                job.scoreTarget = std::stoi(value.text);
+            } else if (key == "count" || key == "limit") {
+                job.resultLimit = std::stoull(value.text);
+            } else if (key == "timeout") {
+                job.timeoutSeconds = std::stod(value.text);
+            } else if (key == "tron") {
+                if (value.text == "true") {
+                    tron = true;
+                } else if (value.text != "false") {
+                    error = "tron должно быть true или false";
+                    return false;
+                }
+            } else if (key == "contract") {
+                if (value.text == "true") {
+                    contract = true;
+                } else if (value.text != "false") {
+                    error = "contract должно быть true или false";
+                    return false;
+                }
+            } else if (key == "max_nonce") {
+                job.contractNonces = std::stoull(value.text) + 1;
+                contract = true;
+            } else if (key == "deployer") {
+                deployer = value.text;
+            } else if (key == "init_code_hash") {
+                initCodeHash = value.text;
+            } else if (key == "split_key") {
+                if (!parsePublicKeyHex(value.text, job.basePoint, error)) {
+                    return false;
+                }
+            } else {
+                error = "неизвестное поле: " + key;
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        error = "некорректное числовое значение";
+        return false;
+    }
+
+    if (tron) {
+        if (job.kind != SearchKind::Mask) {
+            error = "tron работает только с prefix/suffix";
+            return false;
+        }
+        job.kind = SearchKind::Tron;
+    }
+    if (!deployer.empty() || !initCodeHash.empty()) {
+        if (job.kind != SearchKind::Mask || job.splitKey()) {
+            error = "deployer работает только с prefix/suffix";
+            return false;
+        }
+        if (!parseCreate2Params(deployer, initCodeHash, job.create2, error)) {
+            return false;
+        }
+        job.kind = SearchKind::Create2;
+    }
+    if (contract) {
+        if (job.kind == SearchKind::Tron || job.kind == SearchKind::Create2) {
+            error = "contract не работает с tron и deployer";
+            return false;
+        }
+        if (job.contractNonces > MAX_CONTRACT_NONCES) {
+            error = "max_nonce должен быть меньше " + std::to_string(MAX_CONTRACT_NONCES);
+            return false;
+        }
+        job.contractNonces = std::max<size_t>(1, job.contractNonces);
+    }
+    if (job.kind == SearchKind::Patterns) {
+        if (hasMask) {
+            error = "patterns нельзя использовать вместе с prefix/suffix";
+            return false;
+        }
+        if (job.patterns.empty()) {
+            error = "набор шаблонов пуст";
+            return false;
+        }
+        if (fields.find("limit") == fields.end() && fields.find("count") == fields.end()) {
+            job.resultLimit = 0;
+        }
+        job.patterns.build();
+        return true;
+    }
+    if (job.kind == SearchKind::Score) {
+        if (hasMask) {
+            error = "score нельзя использовать вместе с prefix/suffix";
+            return false;
+        }
+        return true;
+    }
+
+    if (job.resultLimit == 0) {
+        error = "count должен быть больше 0";
+        return false;
+    }
+    if (job.kind == SearchKind::Tron) {
+        return compileTronMask(prefixMask, suffixMask, job.tronMask, error);
+    }
+    Mask mask;
+    if (!parseMask(prefixMask, suffixMask, mask, error)) {
+        return false;
+    }
+    job.mask = compileMask(mask);
+    return true;
+}
+
+// Сервер задач: принимает строки запросов от клиентов и ставит задачи в общий пул
+class JobServer {
+public:
+    JobServer(SearchPool& pool, AddressVerifier verify) : pool(pool), verify(std::move(verify)) {}
+
+    // Обслуживание потока строк (stdin/stdout). После конца ввода ждет завершения всех задач
+    int serveStream(std::istream& in, std::ostream& out) {
+        auto client = std::make_shared<Client>();
+        client->write = [&out](const std::string& line) {
+            out << line << std::endl;
+        };
+        std::string line;
+        while (std::getline(in, line)) {
+            handleLine(line, client);
+        }
+        client->waitAll();
+        return 0;
+    }
+
+#ifndef _WIN32
+    // Обслуживание локального Unix-сокета: у каждого подключения свой поток чтения,
+    // задачи всех подключений выполняются в общем пуле. Задачи отключившегося клиента отменяются
+    int serveSocket(const std::string& path) {
+        int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            std::cerr << "Ошибка: не удалось создать сокет" << std::endl;
+            return 1;
+        }
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Ошибка: слишком длинный путь сокета: " << path << std::endl;
+            ::close(listenFd);
+            return 1;
+        }
+        std::copy(path.begin(), path.end(), address.sun_path);
+        ::unlink(path.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd, 16) != 0) {
+            std::cerr << "Ошибка: не удалось открыть сокет: " << path << std::endl;
+            ::close(listenFd);
+            return 1;
+        }
+        // Запись в закрытое клиентом соединение не должна завершать процесс
+        std::signal(SIGPIPE, SIG_IGN);
+
+        while (true) {
+            int clientFd = ::accept(listenFd, nullptr, nullptr);
+            if (clientFd < 0) {
+                continue;
+            }
+            std::thread(&JobServer::serveConnection, this, clientFd).detach();
+        }
+    }
+#endif
+
+private:
+    // Подключенный клиент: вывод строк и его задачи (для отмены по id)
+    struct Client {
+        std::mutex mutex;
+        std::function<void(const std::string&)> write;
+        std::vector<std::shared_ptr<SearchJob>> jobs;
+        bool closed = false;
+
+        void send(const std::string& line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!closed) {
+                write(line);
+            }
+        }
+
+        // Копия списка задач: останавливать и ждать задачи можно только без mutex
+        // клиента, иначе возможна взаимная блокировка с onHit (mutex задачи -> mutex клиента)
+        std::vector<std::shared_ptr<SearchJob>> snapshot() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return jobs;
+        }
+
+        void waitAll() {
+            for (auto& job : snapshot()) {
+                job->wait();
+            }
+        }
+    };
+
+    SearchPool& pool;
+    AddressVerifier verify;
+    std::mutex idMutex;
+    unsigned long long nextId = 1;
+
+    void handleLine(const std::string& line, const std::shared_ptr<Client>& client) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            return;
+        }
+        std::map<std::string, JsonValue> fields;
+        std::string error;
+        if (!parseJsonLine(line, fields, error)) {
+            client->send(errorToJson("", error));
+            return;
+        }
+
+        auto cancel = fields.find("cancel");
+        if (cancel != fields.end()) {
+            for (auto& job : client->snapshot()) {
+                if (job->id == cancel->second.text) {
+                    job->stop(StopReason::Cancelled);
+                }
+            }
+            return;
+        }
+
+        auto job = std::make_shared<SearchJob>();
+        if (!buildJob(fields, *job, error)) {
+            client->send(errorToJson(job->id, error));
+            return;
+        }
+        if (job->id.empty()) {
+            std::lock_guard<std::mutex> lock(idMutex);
+            job->id = std::to_string(nextId++);
+        }
+
+        std::weak_ptr<Client> weakClient = client;
+        job->onHit = [this, weakClient](const SearchJob& job, const SearchHit& hit) {
+            if (auto client = weakClient.lock()) {
+                client->send(hitToJson(job, hit, verify));
+            }
+        };
+        job->onFinish = [weakClient](const SearchJob& job) {
+            if (auto client = weakClient.lock()) {
+                client->send(finishToJson(job));
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(client->mutex);
+            // Завершенные задачи больше не нужны для отмены
+            std::erase_if(client->jobs, [](const std::shared_ptr<SearchJob>& old) { return old->stopped.load(); });
+            client->jobs.push_back(job);
+        }
+        pool.submit(job);
+    }
+
+#ifndef _WIN32
+    void serveConnection(int fd) {
+        auto client = std::make_shared<Client>();
+        client->write = [fd](const std::string& line) {
+            std::string data = line + "\n";
+            size_t written = 0;
+            while (written < data.size()) {
+                ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+                if (n <= 0) {
+                    return;
+                }
+                written += static_cast<size_t>(n);
+            }
+        };
+
+        std::string buffer;
+        char chunk[4096];
+        while (true) {
+            ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n <= 0) {
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+            size_t newline;
+            while ((newline = buffer.find('\n')) != std::string::npos) {
+                handleLine(buffer.substr(0, newline), client);
+                buffer.erase(0, newline + 1);
+            }
+        }
+
+        // Клиент отключился: отменяем его задачи и закрываем соединение,
+        // когда они гарантированно больше ничего не пишут
+        for (auto& job : client->snapshot()) {
+            job->stop(StopReason::Cancelled);
+        }
+        client->waitAll();
+        {
+            std::lock_guard<std::mutex> lock(client->mutex);
+            client->closed = true;
+        }
+        ::close(fd);
+    }
+#endif
+};
+
+#endif // SERVER_H
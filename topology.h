@@ -0,0 +1,259 @@
+// Топология процессора и размещение рабочих потоков.
+// На Linux логические CPU, физические ядра, сокеты и узлы NUMA читаются из sysfs
+// с учетом маски допустимых CPU процесса (taskset, cpuset). План размещения
+// закрепляет каждый поток за своим CPU: либо по одному потоку на физическое ядро,
+// либо на все потоки SMT, чередуя узлы NUMA. На других платформах (и если sysfs
+// недоступен) каждый логический CPU считается отдельным ядром на узле 0.
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct CpuInfo {
+    int cpu = 0;      // Номер логического CPU
+    int core = 0;     // Физическое ядро (уникально в пределах всей системы)
+    int package = 0;  // Сокет
+    int node = 0;     // Узел NUMA
+};
+
+struct CpuTopology {
+    std::vector<CpuInfo> cpus;
+    int nodeCount = 1;
+
+    size_t physicalCores() const {
+        std::set<int> cores;
+        for (const CpuInfo& info : cpus) {
+            cores.insert(info.core);
+        }
+        return cores.size();
+    }
+};
+
+// Режим размещения потоков: --placement none|cores|smt
+enum class Placement {
+    None,   // Без закрепления, потоки распределяет ОС
+    Cores,  // Один поток на физическое ядро
+    Smt     // Все логические CPU, сначала по одному на ядро, затем соседи по SMT
+};
+
+inline bool parsePlacement(const std::string& name, Placement& placement) {
+    if (name == "none") { placement = Placement::None; return true; }
+    if (name == "cores") { placement = Placement::Cores; return true; }
+    if (name == "smt") { placement = Placement::Smt; return true; }
+    return false;
+}
+
+// Место рабочего потока: CPU (-1 - без закрепления) и узел NUMA
+struct ThreadPlacement {
+    int cpu = -1;
+    int node = 0;
+};
+
+// Список CPU в формате sysfs: "0-3,8,10-11"
+inline std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return cpus;
+}
+
+inline bool readSysfsLine(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, line));
+}
+
+inline CpuTopology readCpuTopology() {
+    CpuTopology topology;
+#ifdef __linux__
+    const std::string root = "/sys/devices/system/cpu/";
+    std::string line;
+    std::vector<int> online;
+    if (readSysfsLine(root + "online", line)) {
+        online = parseCpuList(line);
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveAffinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    // Узел каждого CPU из списков узлов NUMA
+    std::map<int, int> nodeOf;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        if (readSysfsLine(entry.path().string() + "/cpulist", line)) {
+            for (int cpu : parseCpuList(line)) {
+                nodeOf[cpu] = std::atoi(name.c_str() + 4);
+            }
+        }
+    }
+
+    // Физическое ядро - пара (сокет, core_id), нумеруем их подряд
+    std::map<std::pair<int, int>, int> coreIds;
+    for (int cpu : online) {
+        if (haveAffinity && cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        CpuInfo info;
+        info.cpu = cpu;
+        std::string base = root + "cpu" + std::to_string(cpu) + "/topology/";
+        int coreId = cpu;
+        if (readSysfsLine(base + "core_id", line)) coreId = std::atoi(line.c_str());
+        if (readSysfsLine(base + "physical_package_id", line)) info.package = std::atoi(line.c_str());
+        auto key = std::make_pair(info.package, coreId);
+        auto found = coreIds.find(key);
+        info.core = found != coreIds.end() ? found->second : static_cast<int>(coreIds.size());
+        coreIds.emplace(key, info.core);
+        auto node = nodeOf.find(cpu);
+        info.node = node != nodeOf.end() ? node->second : 0;
+        topology.cpus.push_back(info);
+    }
+    // Узлы нумеруем подряд, чтобы nodeCount был их количеством
+    std::map<int, int> nodeIndex;
+    for (const CpuInfo& info : topology.cpus) {
+        nodeIndex.emplace(info.node, 0);
+    }
+    int index = 0;
+    for (auto& entry : nodeIndex) {
+        entry.second = index++;
+    }
+    for (CpuInfo& info : topology.cpus) {
+        info.node = nodeIndex[info.node];
+    }
+    topology.nodeCount = std::max(1, index);
+#endif
+    if (topology.cpus.empty()) {
+        unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < count; cpu++) {
+            CpuInfo info;
+            info.cpu = static_cast<int>(cpu);
+            info.core = static_cast<int>(cpu);
+            topology.cpus.push_back(info);
+        }
+        topology.nodeCount = 1;
+    }
+    return topology;
+}
+
+// Порядок CPU для потоков: первые SMT-соседи всех ядер, затем вторые и т.д.;
+// внутри каждого уровня узлы NUMA чередуются, чтобы нагрузка делилась между сокетами.
+// Для Placement::Cores берутся только первые соседи
+inline std::vector<ThreadPlacement> planPlacement(const CpuTopology& topology, Placement placement) {
+    // Номер CPU внутри своего ядра (0 - первый SMT-сосед)
+    std::vector<CpuInfo> cpus = topology.cpus;
+    std::sort(cpus.begin(), cpus.end(), [](const CpuInfo& a, const CpuInfo& b) {
+        return std::tie(a.node, a.core, a.cpu) < std::tie(b.node, b.core, b.cpu);
+    });
+    std::map<int, int> seenPerCore;
+    std::map<std::pair<int, int>, std::vector<CpuInfo>> levels;  // (SMT-уровень, узел) -> CPU
+    int maxLevel = 0;
+    for (const CpuInfo& info : cpus) {
+        int level = seenPerCore[info.core]++;
+        maxLevel = std::max(maxLevel, level);
+        levels[{level, info.node}].push_back(info);
+    }
+
+    std::vector<ThreadPlacement> plan;
+    int lastLevel = placement == Placement::Cores ? 0 : maxLevel;
+    for (int level = 0; level <= lastLevel; level++) {
+        // Чередование узлов: по одному CPU с каждого узла по кругу
+        std::vector<const std::vector<CpuInfo>*> perNode;
+        for (int node = 0; node < topology.nodeCount; node++) {
+            auto found = levels.find({level, node});
+            if (found != levels.end()) {
+                perNode.push_back(&found->second);
+            }
+        }
+        for (size_t i = 0;; i++) {
+            bool any = false;
+            for (const auto* list : perNode) {
+                if (i < list->size()) {
+                    plan.push_back({(*list)[i].cpu, (*list)[i].node});
+                    any = true;
+                }
+            }
+            if (!any) break;
+        }
+    }
+    return plan;
+}
+
+// Размер кэша данных уровня level (1, 2, 3) первого CPU в байтах; 0, если неизвестен
+inline size_t cacheSizeBytes(int level) {
+#ifdef __linux__
+    const std::string root = "/sys/devices/system/cpu/cpu0/cache/";
+    std::string line;
+    for (int index = 0; readSysfsLine(root + "index" + std::to_string(index) + "/level", line); index++) {
+        std::string type, size;
+        if (std::atoi(line.c_str()) != level ||
+            !readSysfsLine(root + "index" + std::to_string(index) + "/type", type) || type == "Instruction" ||
+            !readSysfsLine(root + "index" + std::to_string(index) + "/size", size)) {
+            continue;
+        }
+        // Формат: "2048K" или "1M"
+        size_t value = std::strtoull(size.c_str(), nullptr, 10);
+        char unit = size.empty() ? 0 : size.back();
+        return unit == 'K' ? value << 10 : unit == 'M' ? value << 20 : value;
+    }
+#else
+    (void)level;
+#endif
+    return 0;
+}
+
+// Закрепление текущего потока за CPU; false, если платформа не поддерживает или вызов не удался
+inline bool pinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    if (cpu >= 64) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+#endif // TOPOLOGY_H
@@ -0,0 +1,365 @@
+// Адреса TRON: те же 20 байт, что и у Ethereum (последние 20 байт Keccak-256
+// от публичного ключа), но в виде base58check от 0x41 || адрес: 25 байт
+// с 4 байтами контрольной суммы (двойной SHA-256), 34 символа, начинаются с T.
+// Кодировать каждого кандидата в base58 слишком дорого, поэтому маска один раз
+// переводится в арифметику над сырыми байтами:
+// - начало адреса (префикс) задает интервал 25-байтных чисел, а значит и интервал
+//   20-байтных адресов: проверка - три сравнения 64-битных слов. Контрольная сумма
+//   нужна только на двух граничных адресах интервала;
+// - конец адреса (суффикс) - остаток числа по модулю 58^L. Вклад адреса в остаток
+//   считается по заранее вычисленным весам байт, и при L >= 6 он оставляет не больше
+//   одной подходящей контрольной суммы, так что SHA-256 считается лишь для ~2^32/58^L
+//   кандидатов. Короткий суффикс требует SHA-256 для каждого прошедшего префикс адреса.
+// Base58 и контрольная сумма целиком считаются только для найденных адресов.
+
+#ifndef TRON_H
+#define TRON_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "bytes.h"
+
+// Алфавит base58 (без 0, O, I, l)
+inline constexpr char base58Alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+inline int base58Digit(char c) {
+    for (int i = 0; i < 58; i++) {
+        if (base58Alphabet[i] == c) return i;
+    }
+    return -1;
+}
+
+// SHA-256 (FIPS 180-4) для контрольной суммы base58check
+class Sha256 {
+public:
+    static void hash(const uint8_t* data, size_t size, uint8_t out[32]) {
+        uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        size_t offset = 0;
+        for (; offset + 64 <= size; offset += 64) {
+            compress(state, data + offset);
+        }
+        // Последний блок: остаток, 0x80, нули и длина в битах (big-endian)
+        uint8_t block[128] = {0};
+        size_t rest = size - offset;
+        std::memcpy(block, data + offset, rest);
+        block[rest] = 0x80;
+        size_t blocks = rest + 9 <= 64 ? 1 : 2;
+        uint64_t bits = static_cast<uint64_t>(size) * 8;
+        for (int i = 0; i < 8; i++) {
+            block[blocks * 64 - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        for (size_t b = 0; b < blocks; b++) {
+            compress(state, block + b * 64);
+        }
+        for (int i = 0; i < 8; i++) {
+            out[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+            out[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+            out[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+            out[4 * i + 3] = static_cast<uint8_t>(state[i]);
+        }
+    }
+
+private:
+    static uint32_t rotr(uint32_t x, int n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    static void compress(uint32_t state[8], const uint8_t* block) {
+        static constexpr uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = static_cast<uint32_t>(block[4 * i]) << 24 | static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+                   static_cast<uint32_t>(block[4 * i + 2]) << 8 | block[4 * i + 3];
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+};
+
+// Байт версии адресов TRON в основной сети
+const uint8_t TRON_ADDRESS_PREFIX = 0x41;
+// Длина адреса TRON в base58: 25 байт всегда дают 34 символа
+const int TRON_ADDRESS_LENGTH = 34;
+
+// Контрольная сумма base58check адреса: первые 4 байта SHA-256(SHA-256(0x41 || адрес)), big-endian
+inline uint32_t tronChecksum(const uint8_t* address) {
+    uint8_t payload[21];
+    payload[0] = TRON_ADDRESS_PREFIX;
+    std::memcpy(payload + 1, address, 20);
+    uint8_t first[32], second[32];
+    Sha256::hash(payload, sizeof(payload), first);
+    Sha256::hash(first, sizeof(first), second);
+    return static_cast<uint32_t>(second[0]) << 24 | static_cast<uint32_t>(second[1]) << 16 |
+           static_cast<uint32_t>(second[2]) << 8 | second[3];
+}
+
+// Адрес TRON в base58check (34 символа, начинается с T)
+inline std::string tronAddress(const uint8_t* address) {
+    uint8_t bytes[25];
+    bytes[0] = TRON_ADDRESS_PREFIX;
+    std::memcpy(bytes + 1, address, 20);
+    uint32_t checksum = tronChecksum(address);
+    for (int i = 0; i < 4; i++) {
+        bytes[21 + i] = static_cast<uint8_t>(checksum >> (24 - 8 * i));
+    }
+    // Деление 25-байтного числа на 58 столбиком; ведущих нулей у 0x41... нет
+    char digits[TRON_ADDRESS_LENGTH + 8];
+    int count = 0;
+    bool nonZero = true;
+    while (nonZero) {
+        unsigned remainder = 0;
+        nonZero = false;
+        for (uint8_t& byte : bytes) {
+            unsigned value = remainder << 8 | byte;
+            byte = static_cast<uint8_t>(value / 58);
+            remainder = value % 58;
+            nonZero |= byte != 0;
+        }
+        digits[count++] = base58Alphabet[remainder];
+    }
+    std::string result;
+    while (count > 0) {
+        result += digits[--count];
+    }
+    return result;
+}
+
+// Маска адреса TRON в base58: префикс (с начальной T) и суффикс, без символов '?'
+struct TronMask {
+    // Максимальная длина суффикса: 58^7 < 2^41, остаток считается в 64 битах
+    static constexpr int MAX_SUFFIX = 7;
+
+    std::string prefix;
+    std::string suffix;
+
+    // Интервал адресов [low, high] для префикса (20 байт big-endian, включительно)
+    // и граничные адреса, на которых совпадение зависит от контрольной суммы
+    uint8_t low[20];
+    uint8_t high[20];
+    bool lowPartial = false;
+    bool highPartial = false;
+    uint32_t lowChecksumMin = 0;   // На low: контрольная сумма не меньше
+    uint32_t highChecksumMax = 0;  // На high: контрольная сумма не больше
+    uint64_t lowWords[3], highWords[3];
+
+    // Суффикс: число mod 58^L == target. Вклад адреса - сумма byte * weight по модулю
+    uint64_t modulus = 1;
+    uint64_t target = 0;
+    uint64_t versionWeight = 0;  // 0x41 * 2^192 mod modulus
+    uint64_t weights[20] = {0};  // 2^(8 * (19 - i) + 32) mod modulus
+
+    // Вероятность совпадения случайного адреса
+    double probability() const {
+        double p = 1;
+        // Доля интервала среди 2^160 адресов по старшим 64 битам
+        p *= (static_cast<double>(highWords[0] - lowWords[0]) + 1) / 18446744073709551616.0;
+        return p / static_cast<double>(modulus);
+    }
+
+    bool matches(const uint8_t* address) const {
+        uint64_t a0 = loadBE64(address);
+        if (a0 < lowWords[0] || a0 > highWords[0]) {
+            return false;
+        }
+        // Внутренние значения старшего слова - без сравнения остальных байт
+        if (a0 == lowWords[0] || a0 == highWords[0]) {
+            if (!inRange(address)) {
+                return false;
+            }
+        }
+        if (modulus == 1) {
+            return !onPartialBoundary(address) || boundaryMatches(address, tronChecksum(address));
+        }
+        // Остаток числа без контрольной суммы: (0x41 || адрес) * 2^32 mod 58^L
+        uint64_t residue = versionWeight;
+        for (int i = 0; i < 20; i++) {
+            residue += address[i] * weights[i];
+        }
+        residue %= modulus;
+        // Нужная контрольная сумма: target - residue (mod 58^L); она должна быть < 2^32
+        uint64_t needed = (target + modulus - residue) % modulus;
+        if (modulus > 0xFFFFFFFFULL && needed > 0xFFFFFFFFULL) {
+            return false;
+        }
+        uint32_t checksum = tronChecksum(address);
+        if (checksum % modulus != needed % modulus) {
+            return false;
+        }
+        return !onPartialBoundary(address) || boundaryMatches(address, checksum);
+    }
+
+    // Слова адреса: байты 0..7, 8..15 и 16..19
+    static void splitWords(const uint8_t* address, uint64_t words[3]) {
+        words[0] = loadBE64(address);
+        words[1] = loadBE64(address + 8);
+        words[2] = static_cast<uint64_t>(address[16]) << 24 | address[17] << 16 | address[18] << 8 | address[19];
+    }
+
+private:
+    bool inRange(const uint8_t* address) const {
+        uint64_t words[3];
+        splitWords(address, words);
+        auto less = [](const uint64_t* a, const uint64_t* b) {
+            for (int i = 0; i < 3; i++) {
+                if (a[i] != b[i]) return a[i] < b[i];
+            }
+            return false;
+        };
+        return !less(words, lowWords) && !less(highWords, words);
+    }
+
+    bool onPartialBoundary(const uint8_t* address) const {
+        return (lowPartial && std::memcmp(address, low, 20) == 0) ||
+               (highPartial && std::memcmp(address, high, 20) == 0);
+    }
+
+    bool boundaryMatches(const uint8_t* address, uint32_t checksum) const {
+        if (lowPartial && std::memcmp(address, low, 20) == 0 && checksum < lowChecksumMin) {
+            return false;
+        }
+        if (highPartial && std::memcmp(address, high, 20) == 0 && checksum > highChecksumMax) {
+            return false;
+        }
+        return true;
+    }
+};
+
+// Компиляция маски TRON: префикс должен начинаться с T, символы - из алфавита base58
+inline bool compileTronMask(const std::string& prefix, const std::string& suffix, TronMask& mask,
+                            std::string& error) {
+    for (const std::string* part : {&prefix, &suffix}) {
+        for (char c : *part) {
+            if (base58Digit(c) < 0) {
+                error = std::string("недопустимый символ base58 в маске TRON: ") + c;
+                return false;
+            }
+        }
+    }
+    if (!prefix.empty() && prefix[0] != 'T') {
+        error = "адрес TRON начинается с T, префикс должен начинаться с нее";
+        return false;
+    }
+    if (prefix.size() + suffix.size() > static_cast<size_t>(TRON_ADDRESS_LENGTH)) {
+        error = "префикс и суффикс вместе длиннее адреса TRON (34 символа)";
+        return false;
+    }
+    if (suffix.size() > static_cast<size_t>(TronMask::MAX_SUFFIX)) {
+        error = "суффикс TRON длиннее " + std::to_string(TronMask::MAX_SUFFIX) + " символов";
+        return false;
+    }
+    mask = TronMask();
+    mask.prefix = prefix;
+    mask.suffix = suffix;
+
+    // 25-байтные числа как 7 слов по 32 бита, старшее слово первое
+    using Wide = std::array<uint64_t, 7>;
+    auto mulAdd = [](Wide& x, uint64_t factor, uint64_t add) {
+        uint64_t carry = add;
+        for (int i = 6; i >= 0; i--) {
+            uint64_t value = x[i] * factor + carry;
+            x[i] = value & 0xFFFFFFFFULL;
+            carry = value >> 32;
+        }
+    };
+    auto subOne = [](Wide& x) {
+        for (int i = 6; i >= 0; i--) {
+            if (x[i]-- != 0) break;
+            x[i] = 0xFFFFFFFFULL;
+        }
+    };
+    auto toBytes = [](const Wide& x, uint8_t out[28]) {
+        for (int i = 0; i < 7; i++) {
+            for (int j = 0; j < 4; j++) {
+                out[4 * i + j] = static_cast<uint8_t>(x[i] >> (24 - 8 * j));
+            }
+        }
+    };
+
+    // Префикс: числа от P * 58^(34-L) до (P + 1) * 58^(34-L) - 1
+    Wide lowValue{}, highValue{};
+    for (char c : prefix) {
+        mulAdd(lowValue, 58, static_cast<uint64_t>(base58Digit(c)));
+    }
+    highValue = lowValue;
+    mulAdd(highValue, 1, 1);
+    for (size_t i = prefix.size(); i < static_cast<size_t>(TRON_ADDRESS_LENGTH); i++) {
+        mulAdd(lowValue, 58, 0);
+        mulAdd(highValue, 58, 0);
+    }
+    subOne(highValue);
+
+    // Байты 0..2 - старшие нули 28-байтного представления, 3 - версия,
+    // 4..23 - адрес, 24..27 - контрольная сумма
+    uint8_t lowBytes[28], highBytes[28];
+    toBytes(lowValue, lowBytes);
+    toBytes(highValue, highBytes);
+    auto versionOf = [](const uint8_t* bytes) {
+        return bytes[0] | bytes[1] | bytes[2] ? 0x100 : bytes[3];
+    };
+    int lowVersion = versionOf(lowBytes), highVersion = versionOf(highBytes);
+    if (lowVersion > TRON_ADDRESS_PREFIX || highVersion < TRON_ADDRESS_PREFIX) {
+        error = "адрес TRON не может начинаться с " + prefix;
+        return false;
+    }
+    // Интервал шире всех адресов с версией 0x41 - обрезаем его границы
+    if (lowVersion < TRON_ADDRESS_PREFIX) {
+        std::memset(mask.low, 0x00, 20);
+    } else {
+        std::memcpy(mask.low, lowBytes + 4, 20);
+        mask.lowChecksumMin = static_cast<uint32_t>(lowBytes[24]) << 24 | lowBytes[25] << 16 |
+                              lowBytes[26] << 8 | lowBytes[27];
+        mask.lowPartial = mask.lowChecksumMin != 0;
+    }
+    if (highVersion > TRON_ADDRESS_PREFIX) {
+        std::memset(mask.high, 0xFF, 20);
+    } else {
+        std::memcpy(mask.high, highBytes + 4, 20);
+        mask.highChecksumMax = static_cast<uint32_t>(highBytes[24]) << 24 | highBytes[25] << 16 |
+                               highBytes[26] << 8 | highBytes[27];
+        mask.highPartial = mask.highChecksumMax != 0xFFFFFFFFU;
+    }
+    TronMask::splitWords(mask.low, mask.lowWords);
+    TronMask::splitWords(mask.high, mask.highWords);
+
+    // Суффикс: остаток по модулю 58^L и веса байт адреса
+    for (char c : suffix) {
+        mask.target = mask.target * 58 + static_cast<uint64_t>(base58Digit(c));
+        mask.modulus *= 58;
+    }
+    if (mask.modulus > 1) {
+        uint64_t weight = (1ULL << 32) % mask.modulus;
+        for (int i = 19; i >= 0; i--) {
+            mask.weights[i] = weight;
+            weight = weight * 256 % mask.modulus;
+        }
+        mask.versionWeight = weight * TRON_ADDRESS_PREFIX % mask.modulus;
+    }
+    return true;
+}
+
+#endif // TRON_H